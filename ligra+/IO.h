@@ -31,6 +31,129 @@
 #include "graph.h"
 using namespace std;
 
+//bytes a decoder may read past the end of the last list
+#ifndef GROUP_PADDING
+#define GROUP_PADDING 0
+#endif
+
+//Reads the format header at the start of a compressed file, if there
+//is one, and sets skip to its size. Aborts if the graph cannot be
+//decoded by this program.
+compressionFormat readFormat(long* header, long& skip) {
+#ifdef WEIGHTED
+  bool weighted = 1;
+#else
+  bool weighted = 0;
+#endif
+  compressionFormat f;
+  //number of fields after the magic number, by version
+  long fields = header[0] == FORMAT_MAGIC ? 6 : header[0] == FORMAT_MAGIC_V3 ? 5
+    : header[0] == FORMAT_MAGIC_V2 ? 4 : header[0] == FORMAT_MAGIC_V1 ? 3 : 0;
+  if(fields == 0) {
+    f = compiledFormat(weighted);
+    skip = 0;
+    cout << "no format header, assuming codec = " << codecName(f.codec)
+	 << " chunk = " << f.chunk << endl;
+    return f;
+  }
+  f.codec = header[1]; f.chunk = header[2]; f.weights = header[3];
+  f.skip = fields > 3 ? header[4] : 0;
+  f.index = fields > 4 ? header[5] : INDEX_RAW;
+  f.order = fields > 5 ? header[6] : ORDER_NONE;
+  skip = (fields+1)*sizeof(long);
+  cout << "codec = " << codecName(f.codec) << " chunk = " << f.chunk;
+  if(f.skip) cout << " skip = " << f.skip;
+  if(f.index == INDEX_ELIASFANO) cout << " index = Elias-Fano";
+  if(f.order != ORDER_NONE) cout << " order = " << orderName(f.order);
+  cout << endl;
+  if(f.codec < 0 || f.codec >= NUM_CODECS) {
+    cout << "unknown codec " << f.codec << endl; abort(); }
+#ifdef EDGELONG
+  if(f.codec == CODEC_GROUPVARINT || f.codec == CODEC_PFOR) {
+    cout << "the " << codecName(f.codec) << " code does not support EDGELONG" << endl; abort(); }
+#endif
+  if((f.codec == CODEC_ADAPTIVE || f.codec == CODEC_PFOR) && f.chunk != 0) {
+    cout << codecName(f.codec) << " lists cannot be chunked" << endl; abort(); }
+  if(f.chunk != 0 && f.chunk != PARALLEL_DEGREE) {
+    cout << "unsupported chunk size " << f.chunk << " (expected 0 or "
+	 << PARALLEL_DEGREE << ")" << endl; abort(); }
+  if(f.weights < WEIGHTS_NONE || f.weights > WEIGHTS_SEPARATE) {
+    cout << "unknown weight type " << f.weights << endl; abort(); }
+  //the weights of separate streams can be ignored
+  if(weighted ? f.weights == WEIGHTS_NONE : f.weights == WEIGHTS_INLINE) {
+    cout << (weighted ? "unweighted graph given to a weighted program"
+	     : "weighted graph given to an unweighted program") << endl;
+    abort(); }
+  if(f.index != INDEX_RAW && f.index != INDEX_ELIASFANO) {
+    cout << "unknown index type " << f.index << endl; abort(); }
+  if(f.order < ORDER_NONE || f.order >= NUM_ORDERS) {
+    cout << "unknown order " << f.order << endl; abort(); }
+  if(f.skip < 0 || (f.skip > 0 && !skippable(f))) {
+    cout << "unsupported skip index " << f.skip << endl; abort(); }
+  return f;
+}
+
+//reads the skip index at s+skip (see skipIndex.h) and advances skip
+//past it; sets offsets to the first entry of each vertex
+skipEntry* readSkips(char* s, long& skip, long K, vertexIndex& index, long n, uintT*& offsets) {
+  long numSkips = *((long*) (s+skip));
+  skipEntry* S = (skipEntry*) (s+skip+sizeof(long));
+  skip += sizeof(long) + numSkips*sizeof(skipEntry);
+  offsets = newA(uintT,n+1);
+  {parallel_for(long i=0;i<n;i++) offsets[i] = numSkipEntries(index.degree(i),K);}
+  offsets[n] = 0;
+  if(sequence::plusScan(offsets,offsets,n+1) != numSkips) {
+    cout << "bad skip index" << endl; abort(); }
+  return S;
+}
+
+//reads the weight stream at s+skip (see weightStream in graph.h) and
+//advances skip past it
+weightStream readWeights(char* s, long& skip, vertexIndex& index, long n) {
+  weightStream W;
+  long* header = (long*) (s+skip);
+  W.b = header[0]; W.dictSize = header[1];
+  W.dict = (intE*) (s+skip+2*sizeof(long));
+  skip += 2*sizeof(long) + W.dictSize*sizeof(intE);
+  long bytes = *((long*) (s+skip));
+  W.data = (uchar*) (s+skip+sizeof(long));
+  skip += sizeof(long) + bytes;
+#ifdef WEIGHTED //unweighted programs ignore the weights
+  W.offsets = newA(uintT,n+1);
+  {parallel_for(long i=0;i<n;i++) W.offsets[i] = index.degree(i);}
+  W.offsets[n] = 0;
+  sequence::plusScan(W.offsets,W.offsets,n+1);
+#endif
+  cout << "weights: " << W.b << " bits each";
+  if(W.dictSize) cout << ", dictionary of " << W.dictSize;
+  cout << endl;
+  return W;
+}
+
+//Reads the offsets and degrees of one direction, whose edges take
+//totalSpace bytes and start at s+skip after the raw offsets and
+//degrees, if any; sets edges and advances skip past the edges and the
+//Elias-Fano coded offsets and degrees, if any.
+vertexIndex readDirection(char* s, long& skip, long n, long totalSpace,
+			  const compressionFormat& format, uchar*& edges) {
+  vertexIndex index;
+  if(format.index == INDEX_RAW) {
+    index.offsets = (uintT*) (s+skip);
+    skip += (n+1)*sizeof(uintT);
+    index.degrees = (uintE*) (s+skip);
+    skip += n*sizeof(uintE);
+  }
+  edges = (uchar*) (s+skip);
+  skip += totalSpace;
+  if(format.index == INDEX_ELIASFANO) {
+    index.codedOffsets = readEliasFano(s,skip);
+    index.codedDegrees = readEliasFano(s,skip);
+    if(index.codedOffsets.N != n+1 || index.codedDegrees.N != n+1) {
+      cout << "bad offsets and degrees" << endl; abort(); }
+  }
+  return index;
+}
+
 template <class vertex>
 graph<vertex> readGraph(char* fname, bool isSymmetric) {
   ifstream in(fname,ifstream::in |ios::binary);
@@ -38,44 +161,59 @@ graph<vertex> readGraph(char* fname, bool isSymmetric) {
   long size = in.tellg();
   in.seekg(0);
   cout << "size = " << size << endl;
-  char* s = (char*) malloc(size);
+  char* s = (char*) malloc(size+GROUP_PADDING);
   in.read(s,size);
   long* sizes = (long*) s;
+  long skip = 0;
+  compressionFormat format = readFormat(sizes,skip);
+  sizes = (long*) (s+skip);
   long n = sizes[0], m = sizes[1], totalSpace = sizes[2];
 
   cout << "n = "<<n<<" m = "<<m<<" totalSpace = "<<totalSpace<<endl;
   cout << "reading file..."<<endl;
 
-  uintT* offsets = (uintT*) (s+3*sizeof(long));
-  long skip = 3*sizeof(long) + (n+1)*sizeof(intT);
-  uintE* Degrees = (uintE*) (s+skip);
-  skip+= n*sizeof(intE);
-  uchar* edges = (uchar*)(s+skip);
+  skip += 3*sizeof(long);
+  uchar* edges;
+  vertexIndex index = readDirection(s,skip,n,totalSpace,format,edges);
+  uintT* skipOffsets = NULL, *inSkipOffsets = NULL;
+  skipEntry* skips = NULL, *inSkips = NULL;
+  if(format.skip)
+    skips = readSkips(s,skip,format.skip,index,n,skipOffsets);
+  weightStream weights, inWeights;
+  if(format.weights == WEIGHTS_SEPARATE)
+    weights = readWeights(s,skip,index,n);
 
-  uintT* inOffsets;
+  vertexIndex inIndex;
   uchar* inEdges;
-  uintE* inDegrees;
   if(!isSymmetric){
-    skip += totalSpace;
-    uchar* inData = (uchar*)(s + skip);
-    sizes = (long*) inData;
-    long inTotalSpace = sizes[0];
+    long inTotalSpace = *((long*) (s+skip));
     cout << "inTotalSpace = "<<inTotalSpace<<endl;
     skip += sizeof(long);
-    inOffsets = (uintT*) (s + skip);
-    skip += (n+1)*sizeof(uintT);
-    inDegrees = (uintE*)(s+skip);
-    skip += n*sizeof(uintE);
-    inEdges = (uchar*)(s + skip);
+    inIndex = readDirection(s,skip,n,inTotalSpace,format,inEdges);
+    if(format.skip)
+      inSkips = readSkips(s,skip,format.skip,inIndex,n,inSkipOffsets);
+    if(format.weights == WEIGHTS_SEPARATE)
+      inWeights = readWeights(s,skip,inIndex,n);
   } else {
-    inOffsets = offsets;
+    inIndex = index;
     inEdges = edges;
-    inDegrees = Degrees;
+    inSkipOffsets = skipOffsets;
+    inSkips = skips;
+    inWeights = weights;
   }
 
+  uintE* originalIDs = NULL;
+  if(format.order != ORDER_NONE) originalIDs = (uintE*) (s+skip);
+
   in.close();
 
   cout << "creating graph..."<<endl;
-  graph<vertex> G(inOffsets,offsets,inEdges,edges,n,m,inDegrees,Degrees,s);
+  graph<vertex> G(inIndex,index,inEdges,edges,n,m,s,format);
+  G.outSkipOffsets = skipOffsets; G.outSkips = skips;
+  G.inSkipOffsets = inSkipOffsets; G.inSkips = inSkips;
+  G.outWeights = weights; G.inWeights = inWeights;
+  G.originalIDs = originalIDs;
+  index.del();
+  if(!isSymmetric) inIndex.del();
   return G;
 }
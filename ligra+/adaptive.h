@@ -0,0 +1,358 @@
+// This code is part of the project "Smaller and Faster: Parallel
+// Processing of Compressed Graphs with Ligra+", presented at the IEEE
+// Data Compression Conference, 2015.
+// Copyright (c) 2015 Julian Shun, Laxman Dhulipala and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Adaptive code. Each non-empty list starts with a one-byte tag naming
+// the code used for that list, which the encoder picks as the smallest
+// of: raw (targets stored whole), byte, byteRLE, nibble, and bit-packed
+// differences (defined here). Lists of clustered neighbors tend to get
+// byteRLE, and lists of scattered neighbors nibble or bit-packed codes.
+// Only included from codecs.h, after the other codecs.
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+enum listCode { LIST_RAW, LIST_BYTE, LIST_BYTERLE, LIST_NIBBLE, LIST_BITPACKED, NUM_LIST_CODES };
+
+inline const char* listCodeName(long c) {
+  const char* names[NUM_LIST_CODES] = {"raw","byte","byteRLE","nibble","bitpacked"};
+  return (c >= 0 && c < NUM_LIST_CODES) ? names[c] : "unknown";
+}
+
+//the bit-packed decoder reads 8 bytes at a time, so up to 7 bytes past
+//the end of a list
+#ifndef GROUP_PADDING
+#define GROUP_PADDING 8
+#endif
+
+//*****RAW*****
+
+//targets (and weights) stored whole, unaligned
+namespace rawCode {
+  template <class T, class F>
+  inline void decode(T t, F f, uchar* start, const uintE &source, const uintT &degree) {
+    for(uintT j=0;j<degree;j++) {
+      uintE e;
+      memcpy(&e,start+j*sizeof(uintE),sizeof(uintE));
+      if(!t.srcTarg(f,source,e,j)) return;
+    }
+  }
+
+  template <class T, class F>
+  inline void decodeWgh(T t, F f, uchar* start, const uintE &source, const uintT &degree) {
+    for(uintT j=0;j<degree;j++) {
+      uintE e; intE w;
+      memcpy(&e,start,sizeof(uintE)); start += sizeof(uintE);
+      memcpy(&w,start,sizeof(intE)); start += sizeof(intE);
+      if(!t.srcTarg(f,source,e,w,j)) return;
+    }
+  }
+
+  long sequentialCompressEdgeSet(uchar* edgeArray, long currentOffset, uintT degree,
+				 uintE vertexNum, uintE* savedEdges) {
+    memcpy(edgeArray+currentOffset,savedEdges,degree*sizeof(uintE));
+    return currentOffset+degree*sizeof(uintE);
+  }
+
+  long sequentialCompressWeightedEdgeSet(uchar* edgeArray, long currentOffset, uintT degree,
+					 uintE vertexNum, intEPair* savedEdges) {
+    for(uintT j=0;j<degree;j++) {
+      memcpy(edgeArray+currentOffset,&savedEdges[j].first,sizeof(uintE));
+      currentOffset += sizeof(uintE);
+      memcpy(edgeArray+currentOffset,&savedEdges[j].second,sizeof(intE));
+      currentOffset += sizeof(intE);
+    }
+    return currentOffset;
+  }
+}
+
+//*****BIT-PACKED*****
+
+//The first edge (and weight) is coded as in byte.h. If degree > 1 it
+//is followed by a byte giving the width b of the largest difference,
+//then all degree-1 differences in b bits each. For weighted graphs a
+//second width byte follows the first, and the (zigzag coded) weights
+//of the remaining edges are packed after the differences.
+namespace bitPackedCode {
+  //widths are limited so that a value and its bit offset fit in a word
+#define MAX_PACKED_WIDTH 56
+
+  inline long bitWidth(ulong x) { return x ? 64-__builtin_clzl(x) : 0; }
+  inline ulong zigZag(intE w) { return ((ulong) w << 1) ^ (ulong) ((long) w >> 63); }
+  inline intE unZigZag(ulong x) { return (intE) ((x >> 1) ^ -(x & 1)); }
+
+  inline ulong readBits(uchar* start, long bit, long b) {
+    ulong w;
+    memcpy(&w,start+(bit>>3),sizeof(ulong));
+    return (w >> (bit & 7)) & ((1UL << b)-1);
+  }
+
+  //start must be zeroed
+  inline void writeBits(uchar* start, long bit, long b, ulong x) {
+    for(long i=0;i<b;) {
+      long k = min(8-((bit+i) & 7),b-i);
+      start[(bit+i)>>3] |= ((x >> i) & ((1UL << k)-1)) << ((bit+i) & 7);
+      i += k;
+    }
+  }
+
+  //width of the largest difference, or -1 if it is too wide
+  inline long gapWidth(uintT degree, uintE* E) {
+    ulong x = 0;
+    for(uintT j=1;j<degree;j++) x |= E[j]-E[j-1];
+    long b = bitWidth(x);
+    return b > MAX_PACKED_WIDTH ? -1 : b;
+  }
+  inline long gapWidth(uintT degree, intEPair* E) {
+    ulong x = 0, y = 0;
+    for(uintT j=1;j<degree;j++) {
+      x |= E[j].first-E[j-1].first;
+      y |= zigZag(E[j].second);
+    }
+    long b = max(bitWidth(x),bitWidth(y));
+    return b > MAX_PACKED_WIDTH ? -1 : b;
+  }
+
+  template <class T, class F>
+  inline void decode(T t, F f, uchar* start, const uintE &source, const uintT &degree) {
+    if(degree == 0) return;
+    uintE e = byteCode::eatFirstEdge(start,source);
+    if(!t.srcTarg(f,source,e,0)) return;
+    if(degree == 1) return;
+    long b = *start++;
+    for(uintT j=1;j<degree;j++) {
+      e += readBits(start,(j-1)*b,b);
+      if(!t.srcTarg(f,source,e,j)) return;
+    }
+  }
+
+  template <class T, class F>
+  inline void decodeWgh(T t, F f, uchar* start, const uintE &source, const uintT &degree) {
+    if(degree == 0) return;
+    uintE e = byteCode::eatFirstEdge(start,source);
+    intE w = byteCode::eatWeight(start);
+    if(!t.srcTarg(f,source,e,w,0)) return;
+    if(degree == 1) return;
+    long b = start[0], wb = start[1];
+    start += 2;
+    long weightBits = (degree-1)*b;
+    for(uintT j=1;j<degree;j++) {
+      e += readBits(start,(j-1)*b,b);
+      w = unZigZag(readBits(start,weightBits+(j-1)*wb,wb));
+      if(!t.srcTarg(f,source,e,w,j)) return;
+    }
+  }
+
+  long sequentialCompressEdgeSet(uchar* edgeArray, long currentOffset, uintT degree,
+				 uintE vertexNum, uintE* savedEdges) {
+    if(degree == 0) return currentOffset;
+    currentOffset = byteCode::compressFirstEdge(edgeArray,currentOffset,vertexNum,savedEdges[0]);
+    if(degree == 1) return currentOffset;
+    long b = gapWidth(degree,savedEdges);
+    edgeArray[currentOffset++] = b;
+    uchar* start = edgeArray+currentOffset;
+    long bytes = ((degree-1)*b+7)/8;
+    memset(start,0,bytes);
+    for(uintT j=1;j<degree;j++)
+      writeBits(start,(j-1)*b,b,savedEdges[j]-savedEdges[j-1]);
+    return currentOffset+bytes;
+  }
+
+  long sequentialCompressWeightedEdgeSet(uchar* edgeArray, long currentOffset, uintT degree,
+					 uintE vertexNum, intEPair* savedEdges) {
+    if(degree == 0) return currentOffset;
+    currentOffset = byteCode::compressFirstEdge(edgeArray,currentOffset,vertexNum,savedEdges[0].first);
+    currentOffset = byteCode::compressFirstEdge(edgeArray,currentOffset,0,savedEdges[0].second);
+    if(degree == 1) return currentOffset;
+    ulong x = 0, y = 0;
+    for(uintT j=1;j<degree;j++) {
+      x |= savedEdges[j].first-savedEdges[j-1].first;
+      y |= zigZag(savedEdges[j].second);
+    }
+    long b = bitWidth(x), wb = bitWidth(y);
+    edgeArray[currentOffset++] = b;
+    edgeArray[currentOffset++] = wb;
+    uchar* start = edgeArray+currentOffset;
+    long weightBits = (degree-1)*b, bytes = ((degree-1)*(b+wb)+7)/8;
+    memset(start,0,bytes);
+    for(uintT j=1;j<degree;j++) {
+      writeBits(start,(j-1)*b,b,savedEdges[j].first-savedEdges[j-1].first);
+      writeBits(start,weightBits+(j-1)*wb,wb,zigZag(savedEdges[j].second));
+    }
+    return currentOffset+bytes;
+  }
+}
+
+//*****ADAPTIVE*****
+
+namespace adaptiveCode {
+  template <class T, class F>
+  inline void decode(T t, F f, uchar* start, const uintE &source, const uintT &degree) {
+    if(degree == 0) return;
+    uchar* s = start+1;
+    switch(start[0]) {
+    case LIST_RAW: rawCode::decode(t,f,s,source,degree); break;
+    case LIST_BYTE: byteCode::decode(t,f,s,source,degree); break;
+    case LIST_BYTERLE: byteRLECode::decode(t,f,s,source,degree); break;
+    case LIST_NIBBLE: nibbleCode::decode(t,f,s,source,degree); break;
+    case LIST_BITPACKED: bitPackedCode::decode(t,f,s,source,degree); break;
+    }
+  }
+
+  template <class T, class F>
+  inline void decodeWgh(T t, F f, uchar* start, const uintE &source, const uintT &degree) {
+    if(degree == 0) return;
+    uchar* s = start+1;
+    switch(start[0]) {
+    case LIST_RAW: rawCode::decodeWgh(t,f,s,source,degree); break;
+    case LIST_BYTE: byteCode::decodeWgh(t,f,s,source,degree); break;
+    case LIST_BYTERLE: byteRLECode::decodeWgh(t,f,s,source,degree); break;
+    case LIST_NIBBLE: nibbleCode::decodeWgh(t,f,s,source,degree); break;
+    case LIST_BITPACKED: bitPackedCode::decodeWgh(t,f,s,source,degree); break;
+    }
+  }
+
+  //codes the list with code c into A and returns the bytes used, or -1
+  //if c cannot code it
+  inline long compressWith(long c, uchar* A, uintT d, uintE v, uintE* E) {
+    switch(c) {
+    case LIST_RAW: return rawCode::sequentialCompressEdgeSet(A,0,d,v,E);
+    case LIST_BYTE: return byteCode::sequentialCompressEdgeSet(A,0,d,v,E);
+    case LIST_BYTERLE: return byteRLECode::sequentialCompressEdgeSet(A,0,d,v,E);
+    case LIST_NIBBLE: return (nibbleCode::sequentialCompressEdgeSet(A,0,d,v,E)+1)/2;
+    case LIST_BITPACKED: return bitPackedCode::gapWidth(d,E) < 0 ? -1 :
+	bitPackedCode::sequentialCompressEdgeSet(A,0,d,v,E);
+    }
+    return -1;
+  }
+  inline long compressWith(long c, uchar* A, uintT d, uintE v, intEPair* E) {
+    switch(c) {
+    case LIST_RAW: return rawCode::sequentialCompressWeightedEdgeSet(A,0,d,v,E);
+    case LIST_BYTE: return byteCode::sequentialCompressWeightedEdgeSet(A,0,d,v,E);
+    case LIST_BYTERLE: return byteRLECode::sequentialCompressWeightedEdgeSet(A,0,d,v,E);
+    case LIST_NIBBLE: return (nibbleCode::sequentialCompressWeightedEdgeSet(A,0,d,v,E)+1)/2;
+    case LIST_BITPACKED: return bitPackedCode::gapWidth(d,E) < 0 ? -1 :
+	bitPackedCode::sequentialCompressWeightedEdgeSet(A,0,d,v,E);
+    }
+    return -1;
+  }
+
+  //bit c is set if code c may be used; lists with a skip index (see
+  //skipIndex.h) cannot use byteRLE
+  long candidates = (1L << NUM_LIST_CODES)-1;
+
+  //upper bound on the bytes used by any of the codes for d edges
+  template <class ET>
+  inline long compressBound(uintT d) { return 2*(sizeof(ET)+2)*(long)d + 64; }
+
+  //tries every code on the list and writes the tag and the smallest
+  //coding at edgeArray+currentOffset; returns the new offset
+  template <class ET>
+  long compressList(uchar* edgeArray, long currentOffset, uintT degree, uintE vertexNum, ET* savedEdges) {
+    if(degree == 0) return currentOffset;
+    uchar small[1024];
+    long bound = compressBound<ET>(degree);
+    uchar* scratch = bound <= 1024 ? small : newA(uchar,bound);
+    long best = LIST_RAW, bestSize = LONG_MAX;
+    for(long c=0;c<NUM_LIST_CODES;c++) {
+      if(!(candidates & (1L << c))) continue;
+      long s = compressWith(c,scratch,degree,vertexNum,savedEdges);
+      if(s >= 0 && s < bestSize) { best = c; bestSize = s; }
+    }
+    if(scratch != small) free(scratch);
+    edgeArray[currentOffset] = best;
+    compressWith(best,edgeArray+currentOffset+1,degree,vertexNum,savedEdges);
+    return currentOffset+1+bestSize;
+  }
+
+  long sequentialCompressEdgeSet(uchar* edgeArray, long currentOffset, uintT degree,
+				 uintE vertexNum, uintE* savedEdges) {
+    return compressList(edgeArray,currentOffset,degree,vertexNum,savedEdges);
+  }
+
+  long sequentialCompressWeightedEdgeSet(uchar* edgeArray, long currentOffset, uintT degree,
+					 uintE vertexNum, intEPair* savedEdges) {
+    return compressList(edgeArray,currentOffset,degree,vertexNum,savedEdges);
+  }
+
+  //number of lists, edges and bytes coded with each code
+  struct summary {
+    long lists[NUM_LIST_CODES], edges[NUM_LIST_CODES], bytes[NUM_LIST_CODES];
+    summary() {
+      for(long c=0;c<NUM_LIST_CODES;c++) lists[c] = edges[c] = bytes[c] = 0;
+    }
+    //adds the k lists in A, where list i starts at starts[i], has
+    //degree D[i] and ends at starts[i+1]
+    void add(uchar* A, long* starts, uintE* D, long k) {
+      for(long i=0;i<k;i++) {
+	if(D[i] == 0) continue;
+	long c = A[starts[i]];
+	lists[c]++; edges[c] += D[i]; bytes[c] += starts[i+1]-starts[i];
+      }
+    }
+    void print() {
+      for(long c=0;c<NUM_LIST_CODES;c++) {
+	cout << listCodeName(c) << ": lists = " << lists[c] << " edges = " << edges[c];
+	if(edges[c] > 0) cout << " bits per edge = " << (double)bytes[c]*8/edges[c];
+	cout << endl;
+      }
+    }
+  };
+
+  template <class ET>
+  uchar* parallelCompress(ET* edges, uintT* offsets, long n, long m, uintE* Degrees) {
+    cout << "parallel compressing, (n,m) = (" << n << "," << m << ")" << endl;
+    long* starts = newA(long,n+1);
+    {parallel_for(long i=0;i<n;i++) starts[i] = compressBound<ET>(Degrees[i]);}
+    starts[n] = 0;
+    long toAlloc = sequence::plusScan(starts,starts,n+1);
+    uchar* iEdges = newA(uchar,toAlloc);
+    long* charsUsed = newA(long,n+1);
+    {parallel_for(long i=0;i<n;i++)
+	charsUsed[i] = compressList(iEdges+starts[i],0,Degrees[i],i,edges+offsets[i]);}
+    charsUsed[n] = 0;
+    long totalSpace = sequence::plusScan(charsUsed,charsUsed,n+1);
+    uchar* finalArr = newA(uchar,totalSpace);
+    {parallel_for(long i=0;i<n;i++) {
+	memcpy(finalArr+charsUsed[i],iEdges+starts[i],charsUsed[i+1]-charsUsed[i]);
+	offsets[i] = charsUsed[i];
+      }}
+    offsets[n] = totalSpace;
+    summary S;
+    S.add(finalArr,charsUsed,Degrees,n);
+    S.print();
+    cout << "Average bits per edge: " << (float)totalSpace*8/(float)m << endl;
+    cout << "finished compressing, bytes used = " << totalSpace << endl;
+    free(iEdges); free(starts); free(charsUsed);
+    return finalArr;
+  }
+
+  uintE* parallelCompressEdges(uintE* edges, uintT* offsets, long n, long m, uintE* Degrees) {
+    return (uintE*) parallelCompress(edges,offsets,n,m,Degrees);
+  }
+
+  uchar* parallelCompressWeightedEdges(intEPair* edges, uintT* offsets, long n, long m, uintE* Degrees) {
+    return parallelCompress(edges,offsets,n,m,Degrees);
+  }
+}
+
+#endif
@@ -34,6 +34,8 @@
 #include <string.h>
 
 #define PARALLEL_DEGREE 1000
+//lists with fewer chunks than this are decoded sequentially
+#define PARALLEL_DECODE_CHUNKS 4
 
 #define LAST_BIT_SET(b) (b & (0x80))
 #define EDGE_SIZE_PER_BYTE 7
@@ -123,7 +125,7 @@ template <class T, class F>
       if(!t.srcTarg(f, source,startEdge,edgeID)) return;
     }
     //do remaining chunks in parallel
-    parallel_for(long i=1;i<numChunks;i++) {
+    parallel_for_if(numChunks >= PARALLEL_DECODE_CHUNKS) (long i=1;i<numChunks;i++) {
       long o = i*PARALLEL_DEGREE;
       long end = min<long>(o+PARALLEL_DEGREE,degree);
       uchar* myStart = edgeStart + pOffsets[i-1];
@@ -164,7 +166,7 @@ template <class T, class F>
       if(!t.srcTarg(f, source,startEdge,weight,edgeID)) return;
     }
     //do remaining chunks in parallel
-    parallel_for(long i=1;i<numChunks;i++) {
+    parallel_for_if(numChunks >= PARALLEL_DECODE_CHUNKS) (long i=1;i<numChunks;i++) {
       long o = i*PARALLEL_DEGREE;
       long end = min<long>(o+PARALLEL_DEGREE,degree);
       uchar* myStart = edgeStart + pOffsets[i-1];
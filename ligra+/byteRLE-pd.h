@@ -37,6 +37,8 @@
 #define EDGE_SIZE_PER_BYTE 7
 
 #define PARALLEL_DEGREE 1000
+//lists with fewer chunks than this are decoded sequentially
+#define PARALLEL_DECODE_CHUNKS 4
 
 typedef unsigned char uchar;
 
@@ -171,7 +173,7 @@ template <class T, class F>
     }
 
     //do remaining chunks in parallel
-    {parallel_for(long k=1;k<numChunks;k++) {
+    {parallel_for_if(numChunks >= PARALLEL_DECODE_CHUNKS) (long k=1;k<numChunks;k++) {
       long o = k*PARALLEL_DEGREE;
       long end = o+min<long>(PARALLEL_DEGREE,degree-o);
 
@@ -589,7 +591,7 @@ template <class T, class F>
       }
     }
 
-    {parallel_for(long k=1;k<numChunks;k++) {
+    {parallel_for_if(numChunks >= PARALLEL_DECODE_CHUNKS) (long k=1;k<numChunks;k++) {
       long o = k*PARALLEL_DEGREE;
       long end = o+min<long>(PARALLEL_DEGREE,degree-o);
       uchar* myStart = edgeStart + pOffsets[k-1];
@@ -0,0 +1,219 @@
+// This code is part of the project "Smaller and Faster: Parallel
+// Processing of Compressed Graphs with Ligra+", presented at the IEEE
+// Data Compression Conference, 2015.
+// Copyright (c) 2015 Julian Shun, Laxman Dhulipala and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Runtime codec dispatch. Every codec header is included here in its
+// own namespace, so a single build can decode graphs written with any
+// of them; decode and decodeWgh pick the decoder from the format
+// recorded in the file header (see compressionFormat in graph.h), and
+// the compression functions used by the encoder are dispatched the
+// same way. Weights stored apart from the lists are read through
+// weightRef, so that they are only decoded for edges that are used.
+// The chunked (-pd) decoders go parallel within a vertex only for lists
+// of at least PARALLEL_DECODE_CHUNKS chunks.
+#ifndef CODECS_H
+#define CODECS_H
+
+//everything the codec headers include must be included first, since
+//their own includes would otherwise end up inside the namespaces
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <cmath>
+#include <stdio.h>
+#include <string.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+typedef unsigned char uchar;
+#include "parallel.h"
+#include "utils.h"
+#include "graph.h"
+
+namespace byteCode {
+#include "byte.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+
+namespace byteCodePD {
+#include "byte-pd.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+
+namespace byteRLECode {
+#include "byteRLE.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+
+namespace byteRLECodePD {
+#include "byteRLE-pd.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+
+namespace nibbleCode {
+#include "nibble.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+#undef decode_val_nibblecode
+
+namespace nibbleCodePD {
+#include "nibble-pd.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+#undef decode_val_nibblecode
+
+#ifndef EDGELONG
+namespace groupVarintCode {
+#include "groupVarint.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+
+namespace groupVarintCodePD {
+#include "groupVarint-pd.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+
+namespace pforCode {
+#include "pfor.h"
+}
+#undef BYTECODE_H
+#undef LAST_BIT_SET
+#undef EDGE_SIZE_PER_BYTE
+#endif
+
+typedef pair<uintE,intE> intEPair;
+
+#include "adaptive.h"
+
+#ifndef EDGELONG
+#define GROUPVARINT_CASE(call) case CODEC_GROUPVARINT: return call;
+#define PFOR_CASE(call) case CODEC_PFOR: return call;
+#else
+#define GROUPVARINT_CASE(call)
+#define PFOR_CASE(call)
+#endif
+
+//returns the result of call made in the namespace of the codec of fmt
+#define CODEC_SWITCH(fmt, call)						\
+  if((fmt).chunk == 0) {						\
+    switch((fmt).codec) {						\
+    case CODEC_BYTE: return byteCode::call;				\
+    case CODEC_BYTERLE: return byteRLECode::call;			\
+    case CODEC_NIBBLE: return nibbleCode::call;				\
+    GROUPVARINT_CASE(groupVarintCode::call)				\
+    case CODEC_ADAPTIVE: return adaptiveCode::call;			\
+    PFOR_CASE(pforCode::call)						\
+    }									\
+  } else {								\
+    switch((fmt).codec) {						\
+    case CODEC_BYTE: return byteCodePD::call;				\
+    case CODEC_BYTERLE: return byteRLECodePD::call;			\
+    case CODEC_NIBBLE: return nibbleCodePD::call;			\
+    GROUPVARINT_CASE(groupVarintCodePD::call)				\
+    }									\
+  }
+
+template <class T, class F>
+inline void decode(const compressionFormat& fmt, T t, F f, uchar* edgeStart,
+		   const uintE &source, const uintT &degree) {
+  CODEC_SWITCH(fmt, decode(t,f,edgeStart,source,degree))
+}
+
+template <class T, class F>
+inline void decodeWgh(const compressionFormat& fmt, T t, F f, uchar* edgeStart,
+		      const uintE &source, const uintT &degree) {
+  CODEC_SWITCH(fmt, decodeWgh(t,f,edgeStart,source,degree))
+}
+
+//passes the weights of a list from a weightStream to t
+template <class T>
+struct separateWeightT {
+  T t;
+  const weightStream* W;
+  long first;
+separateWeightT(T _t, const weightStream* _W, long _first) : t(_t), W(_W), first(_first) {}
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const uintT &edgeNumber) {
+    return t.srcTarg(f, src, target, weightRef(W,first+edgeNumber), edgeNumber);
+  }
+};
+
+//decodeWgh for the lists of a graph whose weights (with
+//WEIGHTS_SEPARATE) are in W; weights are read only if t uses them
+template <class T, class F>
+inline void decodeWgh(const compressionFormat& fmt, const weightStream& W, T t, F f,
+		      uchar* edgeStart, const uintE &source, const uintT &degree) {
+  if(fmt.weights == WEIGHTS_SEPARATE)
+    decode(fmt, separateWeightT<T>(t,&W,W.offsets[source]), f, edgeStart, source, degree);
+  else decodeWgh(fmt, t, f, edgeStart, source, degree);
+}
+
+//*****COMPRESSION*****
+
+//the offsets are in nibbles for the nibble codes and bytes otherwise
+long sequentialCompressEdgeSet(const compressionFormat& fmt, uchar* edgeArray, long currentOffset,
+			       uintT degree, uintE vertexNum, uintE* savedEdges) {
+  CODEC_SWITCH(fmt, sequentialCompressEdgeSet(edgeArray,currentOffset,degree,vertexNum,savedEdges))
+  return currentOffset;
+}
+
+long sequentialCompressWeightedEdgeSet(const compressionFormat& fmt, uchar* edgeArray, long currentOffset,
+				       uintT degree, uintE vertexNum, intEPair* savedEdges) {
+  CODEC_SWITCH(fmt, sequentialCompressWeightedEdgeSet(edgeArray,currentOffset,degree,vertexNum,savedEdges))
+  return currentOffset;
+}
+
+uintE* parallelCompressEdges(const compressionFormat& fmt, uintE* edges, uintT* offsets,
+			     long n, long m, uintE* Degrees) {
+  CODEC_SWITCH(fmt, parallelCompressEdges(edges,offsets,n,m,Degrees))
+  return NULL;
+}
+
+uchar* parallelCompressWeightedEdges(const compressionFormat& fmt, intEPair* edges, uintT* offsets,
+				     long n, long m, uintE* Degrees) {
+  CODEC_SWITCH(fmt, parallelCompressWeightedEdges(edges,offsets,n,m,Degrees))
+  return NULL;
+}
+
+#include "skipIndex.h"
+
+#endif
@@ -0,0 +1,135 @@
+// This code is part of the project "Smaller and Faster: Parallel
+// Processing of Compressed Graphs with Ligra+", presented at the IEEE
+// Data Compression Conference, 2015.
+// Copyright (c) 2015 Julian Shun, Laxman Dhulipala and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Elias-Fano code of a nondecreasing sequence of N values in [0,U],
+// used for the offsets and degrees of files compressed with -ef (see
+// vertexIndex in graph.h). The l = log(U/N) low bits of each value are
+// stored packed, and value i sets bit (x >> l) + i of the high bits, so
+// the sequence takes about 2+log(U/N) bits per value. Access finds the
+// i-th set high bit from the position of every EF_SAMPLE-th one, which
+// is sampled when the code is read.
+#ifndef ELIASFANO_H
+#define ELIASFANO_H
+
+#include <iostream>
+#include <fstream>
+#include "parallel.h"
+#include "utils.h"
+
+//set high bits between samples
+#define EF_SAMPLE 256
+
+struct eliasFano {
+  long N, U, l, lowWords, highWords;
+  ulong* low, *high;
+  long* samples; //position of one number k*EF_SAMPLE in high
+eliasFano() : N(0), U(0), l(0), lowWords(0), highWords(0), low(NULL), high(NULL), samples(NULL) {}
+
+  //value i, for 0 <= i < N
+  inline ulong access(long i) const {
+    long k = i/EF_SAMPLE, r = i-k*EF_SAMPLE, pos = samples[k];
+    long w = pos >> 6;
+    ulong word = high[w] & (~0UL << (pos & 63));
+    long c;
+    while((c = __builtin_popcountl(word)) <= r) { r -= c; word = high[++w]; }
+    for(;r>0;r--) word &= word-1;
+    ulong h = (w << 6) + __builtin_ctzl(word) - i;
+    return (h << l) | lowBits(i);
+  }
+
+  inline ulong lowBits(long i) const {
+    if(l == 0) return 0;
+    long bit = i*l, w = bit >> 6, o = bit & 63;
+    ulong x = low[w] >> o;
+    if(o+l > 64) x |= low[w+1] << (64-o);
+    return x & ((1UL << l)-1);
+  }
+
+  long bytes() const { return sizeof(long)*3+sizeof(ulong)*(lowWords+highWords); }
+  void del() { if(samples != NULL) free(samples); }
+};
+
+inline long eliasFanoLowBits(long N, long U) {
+  long l = 0;
+  while(N > 0 && (U >> (l+1)) >= N) l++;
+  return l;
+}
+
+//Writes the code of the N nondecreasing values of A, which are at most
+//U, as N, U, l, the low bits and the high bits.
+template <class T>
+void writeEliasFano(ofstream& out, T* A, long N, long U) {
+  long l = eliasFanoLowBits(N,U);
+  long lowWords = (N*l+63)/64+1, highWords = (N+(U >> l)+1+63)/64;
+  ulong* low = newA(ulong,lowWords), *high = newA(ulong,highWords);
+  {parallel_for(long i=0;i<lowWords;i++) low[i] = 0;}
+  {parallel_for(long i=0;i<highWords;i++) high[i] = 0;}
+  {parallel_for(long i=0;i<N;i++) {
+      ulong x = A[i];
+      long h = (x >> l)+i;
+      __sync_fetch_and_or(&high[h >> 6],1UL << (h & 63));
+      if(l > 0) {
+	ulong y = x & ((1UL << l)-1);
+	long bit = i*l, w = bit >> 6, o = bit & 63;
+	__sync_fetch_and_or(&low[w],y << o);
+	if(o+l > 64) __sync_fetch_and_or(&low[w+1],y >> (64-o));
+      }
+    }}
+  long header[3] = {N, U, l};
+  out.write((char*)header,sizeof(long)*3);
+  out.write((char*)low,sizeof(ulong)*lowWords);
+  out.write((char*)high,sizeof(ulong)*highWords);
+  free(low); free(high);
+}
+
+//reads the code at s+skip and advances skip past it
+eliasFano readEliasFano(char* s, long& skip) {
+  eliasFano E;
+  long* header = (long*) (s+skip);
+  E.N = header[0]; E.U = header[1]; E.l = header[2];
+  E.lowWords = (E.N*E.l+63)/64+1;
+  E.highWords = (E.N+(E.U >> E.l)+1+63)/64;
+  E.low = (ulong*) (s+skip+sizeof(long)*3);
+  E.high = E.low+E.lowWords;
+  skip += E.bytes();
+  //number of ones before each word of high
+  long* ones = newA(long,E.highWords+1);
+  {parallel_for(long w=0;w<E.highWords;w++) ones[w] = __builtin_popcountl(E.high[w]);}
+  ones[E.highWords] = 0;
+  sequence::plusScan(ones,ones,E.highWords+1);
+  //a word holds at most one sample, since EF_SAMPLE >= 64
+  E.samples = newA(long,(E.N+EF_SAMPLE-1)/EF_SAMPLE+1);
+  {parallel_for(long w=0;w<E.highWords;w++) {
+      long k = (ones[w]+EF_SAMPLE-1)/EF_SAMPLE;
+      if(k*EF_SAMPLE < ones[w+1]) {
+	ulong word = E.high[w];
+	for(long r=k*EF_SAMPLE-ones[w];r>0;r--) word &= word-1;
+	E.samples[k] = (w << 6) + __builtin_ctzl(word);
+      }
+    }}
+  free(ones);
+  return E;
+}
+
+#endif
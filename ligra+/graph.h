@@ -5,6 +5,134 @@
 #include <fstream>
 #include <stdlib.h>
 #include "parallel.h"
+#include "eliasFano.h"
+
+// **************************************************************
+//    COMPRESSED FORMAT
+// **************************************************************
+
+//Files written by the encoder begin with FORMAT_MAGIC followed by a
+//compressionFormat saying how the edge lists were coded. Files
+//without it are assumed to use the codec selected at compile time.
+#define FORMAT_MAGIC 0x34462b415247494cL //"LIGRA+F4"
+//older headers, without the order field (V3), the index field (V2)
+//and the skip field (V1)
+#define FORMAT_MAGIC_V3 0x33462b415247494cL //"LIGRA+F3"
+#define FORMAT_MAGIC_V2 0x32462b415247494cL //"LIGRA+F2"
+#define FORMAT_MAGIC_V1 0x31462b415247494cL //"LIGRA+F1"
+
+//edges per independently decodable chunk of a list (-pd codecs)
+#define PARALLEL_DEGREE 1000
+
+//CODEC_ADAPTIVE: each list is tagged with its own code (see adaptive.h)
+enum codecType { CODEC_BYTE, CODEC_BYTERLE, CODEC_NIBBLE, CODEC_GROUPVARINT, CODEC_ADAPTIVE, CODEC_PFOR, NUM_CODECS };
+//WEIGHTS_INLINE: each weight is coded right after its edge
+//WEIGHTS_SEPARATE: lists are coded without weights, which are stored
+//in a weightStream after the lists
+enum weightType { WEIGHTS_NONE, WEIGHTS_INLINE, WEIGHTS_SEPARATE };
+//INDEX_RAW: the offsets and degrees of a direction are arrays of uintT
+//and uintE before its edges
+//INDEX_ELIASFANO: they are Elias-Fano coded after its edges (as the
+//offsets and the cumulative degrees)
+enum indexType { INDEX_RAW, INDEX_ELIASFANO };
+//how the encoder relabeled the vertices (-order); if they were, the
+//original ID of each vertex is stored at the end of the file
+enum orderType { ORDER_NONE, ORDER_BFS, ORDER_SHINGLE, NUM_ORDERS };
+
+struct compressionFormat {
+  long codec; //a codecType
+  long chunk; //edges per chunk, or 0 if lists are not chunked
+  long weights; //a weightType
+  long skip; //edges between skip index entries, or 0 if there is no index
+  long index; //an indexType
+  long order; //an orderType
+};
+
+//Optional skip index (see skipIndex.h): for each list of degree d,
+//entries for edges K, 2K, ... (d-1)/K*K giving the edge value and the
+//position in the list where the edges after it start.
+struct skipEntry {
+  uintT pos;
+  uintE value;
+};
+
+//Weights stored apart from the lists (WEIGHTS_SEPARATE), in edge order
+//and b bits each: either an index into dict, if dictSize > 0, or the
+//zigzag coded weight. The weight of edge j of v is number offsets[v]+j.
+//data is followed by 8 bytes of padding.
+struct weightStream {
+  long b, dictSize;
+  intE* dict;
+  uchar* data;
+  uintT* offsets;
+  weightStream() : b(0), dictSize(0), dict(NULL), data(NULL), offsets(NULL) {}
+  inline intE get(long i) const {
+    long bit = i*b;
+    ulong w;
+    memcpy(&w,data+(bit>>3),sizeof(ulong));
+    ulong x = (w >> (bit & 7)) & ((1UL << b)-1);
+    return dictSize ? dict[x] : (intE) ((x >> 1) ^ -(x & 1));
+  }
+};
+
+//A weight in a weightStream, which is only read when it is converted
+//to intE, i.e. when it is passed to update or updateAtomic
+struct weightRef {
+  const weightStream* W;
+  long i;
+weightRef(const weightStream* _W, long _i) : W(_W), i(_i) {}
+  inline operator intE() const { return W->get(i); }
+};
+
+inline const char* orderName(long o) {
+  const char* names[NUM_ORDERS] = {"none","bfs","shingle"};
+  return (o >= 0 && o < NUM_ORDERS) ? names[o] : "unknown";
+}
+
+inline const char* codecName(long c) {
+  const char* names[NUM_CODECS] = {"byte","byteRLE","nibble","groupVarint","adaptive","PFOR"};
+  return (c >= 0 && c < NUM_CODECS) ? names[c] : "unknown";
+}
+
+//the format given by the BYTE, NIBBLE, GROUPVARINT, PFOR and PD flags
+inline compressionFormat compiledFormat(bool weighted) {
+  compressionFormat f;
+#if defined(BYTE)
+  f.codec = CODEC_BYTE;
+#elif defined(NIBBLE)
+  f.codec = CODEC_NIBBLE;
+#elif defined(GROUPVARINT)
+  f.codec = CODEC_GROUPVARINT;
+#elif defined(PFOR)
+  f.codec = CODEC_PFOR;
+#else
+  f.codec = CODEC_BYTERLE;
+#endif
+#if defined(PD) && !defined(PFOR) //PFOR lists are not chunked
+  f.chunk = PARALLEL_DEGREE;
+#else
+  f.chunk = 0;
+#endif
+  f.weights = weighted ? WEIGHTS_INLINE : WEIGHTS_NONE;
+  f.skip = 0;
+  f.index = INDEX_RAW;
+  f.order = ORDER_NONE;
+  return f;
+}
+
+//The offsets (in bytes) and degrees of the lists of one direction
+struct vertexIndex {
+  uintT* offsets; //NULL if Elias-Fano coded
+  uintE* degrees;
+  eliasFano codedOffsets, codedDegrees; //offsets and cumulative degrees
+vertexIndex() : offsets(NULL), degrees(NULL) {}
+vertexIndex(uintT* _offsets, uintE* _degrees) : offsets(_offsets), degrees(_degrees) {}
+  inline long offset(long i) const {
+    return offsets != NULL ? offsets[i] : codedOffsets.access(i); }
+  inline uintE degree(long i) const {
+    return degrees != NULL ? degrees[i] : codedDegrees.access(i+1)-codedDegrees.access(i); }
+  void del() { codedOffsets.del(); codedDegrees.del(); }
+};
 
 // **************************************************************
 //    ADJACENCY ARRAY REPRESENTATION
@@ -41,30 +169,58 @@ struct asymmetricVertex {
     swap(inDegree,outDegree); }
 };
 
+//Edges grouped into tiles by destination and source range (see
+//edgeTiles.h), built by buildEdgeTiles for the EDGE_STREAM option of
+//edgeMap. Vertices are split into numParts ranges of 2^logB; the edges
+//from range i to range j are src/dst[offsets[j*numParts+i]..
+//offsets[j*numParts+i+1]-1], in order of source.
+struct edgeTiles {
+  long n, logB, numParts;
+  long* offsets;
+  uintE* src, *dst;
+  intE* weights; //NULL if unweighted
+  bool transposed; //direction of the graph when the tiles were built
+  void del() { free(offsets); free(src); free(dst); if(weights != NULL) free(weights); }
+};
+
 template <class vertex>
 struct graph {
   vertex *V;
   long n;
   long m;
-  uintT* inOffsets, *outOffsets;
+  uintT* inOffsets, *outOffsets; //NULL if Elias-Fano coded
   uchar* inEdges, *outEdges;
   uintE* flags;
   char* s;
   bool transposed;
-graph(uintT* _inOffsets, uintT* _outOffsets, uchar* _inEdges, uchar* _outEdges, long nn, long mm, uintE* inDegrees, uintE* outDegrees, char* _s) 
-: inOffsets(_inOffsets), outOffsets(_outOffsets), inEdges(_inEdges), outEdges(_outEdges), n(nn), m(mm), s(_s), flags(NULL), transposed(false) {
+  compressionFormat format;
+  //first skip entry of each vertex, and the entries; NULL if no index
+  uintT* inSkipOffsets, *outSkipOffsets;
+  skipEntry* inSkips, *outSkips;
+  //decoded lists of high-degree vertices (see cacheLists in ligra.h):
+  //the list of v is at inCache[v] (or outCache[v]) if it is not NULL,
+  //with the weight of each edge after its target if weighted
+  uintE** inCache, **outCache;
+  uintE* cacheData;
+  weightStream inWeights, outWeights; //if format.weights is WEIGHTS_SEPARATE
+  uintE* originalIDs; //ID of each vertex in the input to the encoder, or NULL
+  edgeTiles* tiles; //NULL unless built by buildEdgeTiles
+graph(vertexIndex& inIndex, vertexIndex& outIndex, uchar* _inEdges, uchar* _outEdges, long nn, long mm, char* _s, compressionFormat _format) 
+: inOffsets(inIndex.offsets), outOffsets(outIndex.offsets), inEdges(_inEdges), outEdges(_outEdges), n(nn), m(mm), s(_s), flags(NULL), transposed(false), format(_format),
+  inSkipOffsets(NULL), outSkipOffsets(NULL), inSkips(NULL), outSkips(NULL),
+  inCache(NULL), outCache(NULL), cacheData(NULL), originalIDs(NULL), tiles(NULL) {
   V = newA(vertex,n);
   parallel_for(long i=0;i<n;i++) {
-    long o = outOffsets[i];
-    uintT d = outDegrees[i];
+    long o = outIndex.offset(i);
+    uintT d = outIndex.degree(i);
     V[i].setOutDegree(d);
     V[i].setOutNeighbors(outEdges+o);
   }
 
   if(sizeof(vertex) == sizeof(asymmetricVertex)){
     parallel_for(long i=0;i<n;i++) {
-      long o = inOffsets[i];
-      uintT d = inDegrees[i];
+      long o = inIndex.offset(i);
+      uintT d = inIndex.degree(i);
       V[i].setInDegree(d);
       V[i].setInNeighbors(inEdges+o);
     }
@@ -75,11 +231,24 @@ graph(uintT* _inOffsets, uintT* _outOffsets, uchar* _inEdges, uchar* _outEdges,
     free(s);
     free(V);
     if(flags != NULL) free(flags);
+    if(outSkipOffsets != NULL) free(outSkipOffsets);
+    if(inSkipOffsets != NULL && inSkipOffsets != outSkipOffsets) free(inSkipOffsets);
+    if(outCache != NULL) free(outCache);
+    if(inCache != NULL && inCache != outCache) free(inCache);
+    if(cacheData != NULL) free(cacheData);
+    if(tiles != NULL) { tiles->del(); free(tiles); }
+    if(outWeights.offsets != NULL) free(outWeights.offsets);
+    if(inWeights.offsets != NULL && inWeights.offsets != outWeights.offsets)
+      free(inWeights.offsets);
   }
   void transpose() {
     if(sizeof(vertex) == sizeof(asymmetricVertex)) {
       parallel_for(long i=0;i<n;i++)
 	V[i].flipEdges();
+      swap(inSkipOffsets,outSkipOffsets);
+      swap(inSkips,outSkips);
+      swap(inCache,outCache);
+      swap(inWeights,outWeights);
       transposed = !transposed;
     }
   }
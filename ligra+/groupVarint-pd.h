@@ -0,0 +1,488 @@
+// This code is part of the project "Smaller and Faster: Parallel
+// Processing of Compressed Graphs with Ligra+", presented at the IEEE
+// Data Compression Conference, 2015.
+// Copyright (c) 2015 Julian Shun, Laxman Dhulipala and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Group varint code. The first edge of a list is stored as in byte.h,
+// as the signed difference from the source, and the remaining
+// differences are stored in groups of four. Each group starts with a
+// control byte holding the length in bytes (1-4) of each of its values
+// in 2 bits, followed by the values in little-endian order. With SSSE3
+// a group is decoded with one byte shuffle and a prefix sum instead of
+// a branch per byte. For weighted graphs, each group of differences is
+// followed by a group of the (zigzag coded) weights of those edges.
+// This version splits lists into chunks of PARALLEL_DEGREE edges that
+// are decoded in parallel, as in byte-pd.h.
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <cmath>
+#include "parallel.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#if defined(EDGELONG)
+#error "the group varint code only supports 32-bit edges"
+#endif
+
+#define PARALLEL_DEGREE 1000
+//lists with fewer chunks than this are decoded sequentially
+#define PARALLEL_DECODE_CHUNKS 4
+
+#define GROUP_PADDING 16
+
+#define LAST_BIT_SET(b) (b & (0x80))
+#define EDGE_SIZE_PER_BYTE 7
+
+typedef unsigned char uchar;
+
+//data bytes used by each control byte and the shuffle that moves its
+//values into four 32-bit lanes
+struct groupTables {
+  uchar length[256];
+  uchar shuffle[256][16] __attribute__((aligned(16)));
+  groupTables() {
+    for(int c=0;c<256;c++) {
+      int o = 0;
+      for(int i=0;i<4;i++) {
+	int len = ((c >> (2*i)) & 3) + 1;
+	for(int b=0;b<4;b++) shuffle[c][4*i+b] = (b < len) ? o+b : 0x80;
+	o += len;
+      }
+      length[c] = o;
+    }
+  }
+};
+
+//a template, so that the tables can be defined in this header; they
+//are built before main
+template <int dummy>
+struct groupTablesHolder { static groupTables T; };
+template <int dummy>
+groupTables groupTablesHolder<dummy>::T;
+
+/* Reads the first edge of an out-edge list, which is the signed
+   difference between the target and source. 
+*/
+inline intE eatWeight(uchar* &start) {
+  uchar fb = *start++;
+  intE edgeRead = (fb & 0x3f);
+  if (LAST_BIT_SET(fb)) {
+    int shiftAmount = 6;
+    while (1) {
+      uchar b = *start;
+      edgeRead |= ((b & 0x7f) << shiftAmount);
+      start++;
+      if (LAST_BIT_SET(b))
+        shiftAmount += EDGE_SIZE_PER_BYTE;
+      else 
+        break;
+    }
+  }
+  return (fb & 0x40) ? -edgeRead : edgeRead;
+}
+
+inline intE eatFirstEdge(uchar* &start, uintE source) {
+  uchar fb = *start++;
+  intE edgeRead = (fb & 0x3f);
+  if (LAST_BIT_SET(fb)) {
+    int shiftAmount = 6;
+    while (1) {
+      uchar b = *start;
+      edgeRead |= ((b & 0x7f) << shiftAmount);
+      start++;
+      if (LAST_BIT_SET(b))
+        shiftAmount += EDGE_SIZE_PER_BYTE;
+      else 
+        break;
+    }
+  }
+  return (fb & 0x40) ? source - edgeRead : source + edgeRead;
+}
+
+inline intE unZigZag(uintE x) { return (intE) ((x >> 1) ^ -(x & 1)); }
+inline uintE zigZag(intE x) { return ((uintE) x << 1) ^ (uintE) (x >> 31); }
+
+/*
+  Reads the k values of a group. With SSSE3, the 16 bytes after the
+  control byte are loaded at once; this can read past the end of the
+  last list, so the edge array must be followed by GROUP_PADDING bytes
+  (readGraph in IO.h allocates them). The unused control bits of a
+  partial group are 0, i.e. length 1, so the lengths of the values
+  that are not there are subtracted.
+*/
+inline void eatGroup(uchar* &start, uintE* values, long k) {
+  uchar c = *start++;
+#if defined(__SSSE3__)
+  const groupTables& T = groupTablesHolder<0>::T;
+  __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*) start),
+			       _mm_load_si128((__m128i*) T.shuffle[c]));
+  _mm_storeu_si128((__m128i*) values,v);
+  start += T.length[c] - (4-k);
+#else
+  for(long i=0;i<k;i++) {
+    int len = ((c >> (2*i)) & 3) + 1;
+    uintE v = 0;
+    for(int b=0;b<len;b++) v |= (uintE) start[b] << (8*b);
+    values[i] = v;
+    start += len;
+  }
+#endif
+}
+
+/*
+  Reads a group of k differences and turns them into edges by adding
+  them to prev (a prefix sum).
+*/
+inline void eatEdgeGroup(uchar* &start, uintE* edges, long k, uintE prev) {
+#if defined(__SSSE3__)
+  const groupTables& T = groupTablesHolder<0>::T;
+  uchar c = *start++;
+  __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*) start),
+			       _mm_load_si128((__m128i*) T.shuffle[c]));
+  v = _mm_add_epi32(v,_mm_slli_si128(v,4));
+  v = _mm_add_epi32(v,_mm_slli_si128(v,8));
+  v = _mm_add_epi32(v,_mm_set1_epi32(prev));
+  _mm_storeu_si128((__m128i*) edges,v);
+  start += T.length[c] - (4-k);
+#else
+  eatGroup(start,edges,k);
+  for(long i=0;i<k;i++) edges[i] = prev = prev + edges[i];
+#endif
+}
+
+/*
+  Decodes the chunk of edges [o,end) starting at start, calling
+  srcTarg on each. Returns false if srcTarg asked to stop.
+*/
+template <class T, class F>
+  inline bool decodeChunk(T &t, F &f, uchar* start, const uintE &source, long o, long end) {
+  uintE edge = eatFirstEdge(start,source);
+  if (!t.srcTarg(f, source, edge, o)) return 0;
+  uintE edges[4];
+  long rest = end-o-1;
+  uintT edgesRead = o+1;
+  for(long g=0;g<rest;g+=4) {
+    long k = min<long>(4,rest-g);
+    eatEdgeGroup(start,edges,k,edge);
+    for(long i=0;i<k;i++)
+      if (!t.srcTarg(f, source, edges[i], edgesRead++)) return 0;
+    edge = edges[k-1];
+  }
+  return 1;
+}
+
+template <class T, class F>
+  inline bool decodeWghChunk(T &t, F &f, uchar* start, const uintE &source, long o, long end) {
+  uintE edge = eatFirstEdge(start,source);
+  intE weight = eatWeight(start);
+  if (!t.srcTarg(f, source, edge, weight, o)) return 0;
+  uintE edges[4], weights[4];
+  long rest = end-o-1;
+  uintT edgesRead = o+1;
+  for(long g=0;g<rest;g+=4) {
+    long k = min<long>(4,rest-g);
+    eatEdgeGroup(start,edges,k,edge);
+    eatGroup(start,weights,k);
+    for(long i=0;i<k;i++)
+      if (!t.srcTarg(f, source, edges[i], unZigZag(weights[i]), edgesRead++)) return 0;
+    edge = edges[k-1];
+  }
+  return 1;
+}
+
+/*
+  The main decoding work-horse. The first chunk is decoded
+  sequentially, and the remaining chunks in parallel.
+*/
+template <class T, class F>
+  inline void decode(T t, F f, uchar* edgeStart, const uintE &source, const uintT &degree) {
+  if (degree > 0) {
+    long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
+    uintE* pOffsets = (uintE*) edgeStart; //use beginning of edgeArray for offsets into edge list
+    uchar* start = edgeStart + (numChunks-1)*sizeof(uintE);
+    if(!decodeChunk(t,f,start,source,0,min<long>(PARALLEL_DEGREE,degree))) return;
+    parallel_for_if(numChunks >= PARALLEL_DECODE_CHUNKS) (long i=1;i<numChunks;i++) {
+      long o = i*PARALLEL_DEGREE;
+      decodeChunk(t,f,edgeStart+pOffsets[i-1],source,o,min<long>(o+PARALLEL_DEGREE,degree));
+    }
+  }
+}
+
+//decode edges for weighted graph
+template <class T, class F>
+  inline void decodeWgh(T t, F f, uchar* edgeStart, const uintE &source, const uintT &degree) {
+  if (degree > 0) {
+    long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
+    uintE* pOffsets = (uintE*) edgeStart; //use beginning of edgeArray for offsets into edge list
+    uchar* start = edgeStart + (numChunks-1)*sizeof(uintE);
+    if(!decodeWghChunk(t,f,start,source,0,min<long>(PARALLEL_DEGREE,degree))) return;
+    parallel_for_if(numChunks >= PARALLEL_DECODE_CHUNKS) (long i=1;i<numChunks;i++) {
+      long o = i*PARALLEL_DEGREE;
+      decodeWghChunk(t,f,edgeStart+pOffsets[i-1],source,o,min<long>(o+PARALLEL_DEGREE,degree));
+    }
+  }
+}
+
+/*
+  Compresses the first edge, writing target-source and a sign bit. 
+*/
+long compressFirstEdge(uchar *start, long offset, uintE source, uintE target) {
+  intE preCompress = (intE) target - source;
+  uchar firstByte = 0;
+  intE toCompress = abs(preCompress);
+  firstByte = toCompress & 0x3f; // 0011|1111
+  if (preCompress < 0) {
+    firstByte |= 0x40;
+  }
+  toCompress = toCompress >> 6;
+  if (toCompress > 0) {
+    firstByte |= 0x80;
+  }
+  start[offset] = firstByte;
+  offset++;
+
+  uchar curByte = toCompress & 0x7f;
+  while ((curByte > 0) || (toCompress > 0)) {
+    uchar toWrite = curByte;
+    toCompress = toCompress >> 7;
+    // Check to see if there's any bits left to represent
+    curByte = toCompress & 0x7f;
+    if (toCompress > 0) {
+      toWrite |= 0x80; 
+    }
+    start[offset] = toWrite;
+    offset++;
+  }
+  return offset;
+}
+
+/*
+  Writes a group of k <= 4 values: the control byte, then each value
+  in as few bytes as possible.
+*/
+long compressGroup(uchar *start, long offset, uintE* values, long k) {
+  long controlOffset = offset++;
+  uchar control = 0;
+  for(long i=0;i<k;i++) {
+    uintE v = values[i];
+    int len = (v < (1 << 8)) ? 1 : (v < (1 << 16)) ? 2 : (v < (1 << 24)) ? 3 : 4;
+    control |= (len-1) << (2*i);
+    for(int b=0;b<len;b++) start[offset++] = (v >> (8*b)) & 0xff;
+  }
+  start[controlOffset] = control;
+  return offset;
+}
+
+/*
+  Takes: 
+    1. The edge array of chars to write into
+    2. The current offset into this array
+    3. The vertices degree
+    4. The vertices vertex number
+    5. The array of saved out-edges we're compressing
+  Returns:
+    The new offset into the edge array
+*/
+long sequentialCompressEdgeSet(uchar *edgeArray, long currentOffset, uintT degree, 
+                                uintE vertexNum, uintE *savedEdges) {
+  if (degree > 0) {
+    long startOffset = currentOffset;
+    long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
+    uintE* pOffsets = (uintE*) edgeArray; //use beginning of edgeArray for offsets into edge list
+    currentOffset += (numChunks-1)*sizeof(uintE);
+    uintE differences[4];
+    for(long i=0;i<numChunks;i++) {
+      long o = i*PARALLEL_DEGREE;
+      long end = min<long>(PARALLEL_DEGREE,degree-o);
+      uintE* myEdges = savedEdges + o;
+      if(i > 0) pOffsets[i-1] = currentOffset-startOffset; //store offset for all chunks but the first
+      // Compress the first edge whole, which is signed difference coded
+      currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+					vertexNum, myEdges[0]);
+      for (long edgeI=1; edgeI < end; edgeI+=4) {
+	long k = min<long>(4,end-edgeI);
+	for(long j=0;j<k;j++)
+	  differences[j] = myEdges[edgeI+j] - myEdges[edgeI+j-1];
+	currentOffset = compressGroup(edgeArray, currentOffset, differences, k);
+      }
+    }
+  }
+  return currentOffset;
+}
+
+/*
+  Compresses the edge set in parallel. 
+*/
+uintE *parallelCompressEdges(uintE *edges, uintT *offsets, long n, long m, uintE* Degrees) {
+  cout << "parallel compressing, (n,m) = (" << n << "," << m << ")" << endl;
+  uintE **edgePts = newA(uintE*, n);
+  uintT *degrees = newA(uintT, n+1);
+  long *charsUsedArr = newA(long, n);
+  long *compressionStarts = newA(long, n+1);
+  {parallel_for(long i=0; i<n; i++) { 
+      degrees[i] = Degrees[i];
+    charsUsedArr[i] = ceil((degrees[i] * 9) / 8) + 4;
+  }}
+  degrees[n] = 0;
+  sequence::plusScan(degrees,degrees, n+1);
+  long toAlloc = sequence::plusScan(charsUsedArr,charsUsedArr,n);
+  uintE* iEdges = newA(uintE,toAlloc);
+
+  {parallel_for(long i=0; i<n; i++) {
+      edgePts[i] = iEdges+charsUsedArr[i];
+      long charsUsed = 
+	sequentialCompressEdgeSet((uchar *)(iEdges+charsUsedArr[i]), 
+				  0, degrees[i+1]-degrees[i],
+				  i, edges + offsets[i]);
+      charsUsedArr[i] = charsUsed;
+  }}
+
+  // produce the total space needed for all compressed lists in chars. 
+  long totalSpace = sequence::plusScan(charsUsedArr, compressionStarts, n);
+  compressionStarts[n] = totalSpace;
+  free(degrees);
+  free(charsUsedArr);
+  
+  uchar *finalArr = newA(uchar, totalSpace);
+  cout << "total space requested is : " << totalSpace << endl;
+  float avgBitsPerEdge = (float)totalSpace*8 / (float)m; 
+  cout << "Average bits per edge: " << avgBitsPerEdge << endl;
+
+  {parallel_for(long i=0; i<n; i++) {
+      long o = compressionStarts[i];
+    memcpy(finalArr + o, (uchar *)(edgePts[i]), compressionStarts[i+1]-o);
+    offsets[i] = o;
+  }}
+  offsets[n] = totalSpace;
+  free(iEdges);
+  free(edgePts);
+  free(compressionStarts);
+  cout << "finished compressing, bytes used = " << totalSpace << endl;
+  cout << "would have been, " << (m * 4) << endl;
+  return ((uintE *)finalArr);
+}
+
+typedef pair<uintE,intE> intEPair;
+
+/*
+  Takes: 
+    1. The edge array of chars to write into
+    2. The current offset into this array
+    3. The vertices degree
+    4. The vertices vertex number
+    5. The array of saved out-edges we're compressing
+  Returns:
+    The new offset into the edge array
+*/
+long sequentialCompressWeightedEdgeSet
+(uchar *edgeArray, long currentOffset, uintT degree, 
+ uintE vertexNum, intEPair *savedEdges) {
+  if (degree > 0) {
+    long startOffset = currentOffset;
+    long numChunks = 1+(degree-1)/PARALLEL_DEGREE;
+    uintE* pOffsets = (uintE*) edgeArray; //use beginning of edgeArray for offsets into edge list
+    currentOffset += (numChunks-1)*sizeof(uintE);
+    uintE differences[4], weights[4];
+    for(long i=0;i<numChunks;i++) {
+      long o = i*PARALLEL_DEGREE;
+      long end = min<long>(PARALLEL_DEGREE,degree-o);
+      intEPair* myEdges = savedEdges + o;
+      if(i > 0) pOffsets[i-1] = currentOffset-startOffset; //store offset for all chunks but the first
+      //target ID
+      currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+					vertexNum, myEdges[0].first);
+      //weight
+      currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+					0, myEdges[0].second);
+      for (long edgeI=1; edgeI < end; edgeI+=4) {
+	long k = min<long>(4,end-edgeI);
+	for(long j=0;j<k;j++) {
+	  differences[j] = myEdges[edgeI+j].first - myEdges[edgeI+j-1].first;
+	  weights[j] = zigZag(myEdges[edgeI+j].second);
+	}
+	currentOffset = compressGroup(edgeArray, currentOffset, differences, k);
+	currentOffset = compressGroup(edgeArray, currentOffset, weights, k);
+      }
+    }
+  }
+  return currentOffset;
+}
+
+/*
+  Compresses the weighted edge set in parallel. 
+*/
+uchar *parallelCompressWeightedEdges(intEPair *edges, uintT *offsets, long n, long m, uintE* Degrees) {
+  cout << "parallel compressing, (n,m) = (" << n << "," << m << ")" << endl;
+  uintE **edgePts = newA(uintE*, n);
+  uintT *degrees = newA(uintT, n+1);
+  long *charsUsedArr = newA(long, n);
+  long *compressionStarts = newA(long, n+1);
+  {parallel_for(long i=0; i<n; i++) { 
+    degrees[i] = Degrees[i];
+    charsUsedArr[i] = 2*(ceil((degrees[i] * 9) / 8) + 4);
+  }}
+  degrees[n] = 0;
+  sequence::plusScan(degrees,degrees, n+1);
+  long toAlloc = sequence::plusScan(charsUsedArr,charsUsedArr,n);
+  uintE* iEdges = newA(uintE,toAlloc);
+
+  {parallel_for(long i=0; i<n; i++) {
+    edgePts[i] = iEdges+charsUsedArr[i];
+    long charsUsed = 
+      sequentialCompressWeightedEdgeSet((uchar *)(iEdges+charsUsedArr[i]), 0, degrees[i+1]-degrees[i],i, edges + offsets[i]);
+    charsUsedArr[i] = charsUsed;
+  }}
+
+  // produce the total space needed for all compressed lists in chars. 
+  long totalSpace = sequence::plusScan(charsUsedArr, compressionStarts, n);
+  compressionStarts[n] = totalSpace;
+  free(degrees);
+  free(charsUsedArr);
+
+  uchar *finalArr = newA(uchar, totalSpace);
+  cout << "total space requested is : " << totalSpace << endl;
+  float avgBitsPerEdge = (float)totalSpace*8 / (float)m; 
+  cout << "Average bits per edge: " << avgBitsPerEdge << endl;
+
+  {parallel_for(long i=0; i<n; i++) {
+      long o = compressionStarts[i];
+    memcpy(finalArr + o, (uchar *)(edgePts[i]), compressionStarts[i+1]-o);
+    offsets[i] = o;
+  }}
+  offsets[n] = totalSpace;
+  free(iEdges);
+  free(edgePts);
+  free(compressionStarts);
+  cout << "finished compressing, bytes used = " << totalSpace << endl;
+  cout << "would have been, " << (m * 8) << endl;
+  return finalArr;
+}
+
+#endif
@@ -0,0 +1,434 @@
+// This code is part of the project "Smaller and Faster: Parallel
+// Processing of Compressed Graphs with Ligra+", presented at the IEEE
+// Data Compression Conference, 2015.
+// Copyright (c) 2015 Julian Shun, Laxman Dhulipala and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Group varint code. The first edge of a list is stored as in byte.h,
+// as the signed difference from the source, and the remaining
+// differences are stored in groups of four. Each group starts with a
+// control byte holding the length in bytes (1-4) of each of its values
+// in 2 bits, followed by the values in little-endian order. With SSSE3
+// a group is decoded with one byte shuffle and a prefix sum instead of
+// a branch per byte. For weighted graphs, each group of differences is
+// followed by a group of the (zigzag coded) weights of those edges.
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <cmath>
+#include "parallel.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#if defined(EDGELONG)
+#error "the group varint code only supports 32-bit edges"
+#endif
+
+#define GROUP_PADDING 16
+
+#define LAST_BIT_SET(b) (b & (0x80))
+#define EDGE_SIZE_PER_BYTE 7
+
+typedef unsigned char uchar;
+
+//data bytes used by each control byte and the shuffle that moves its
+//values into four 32-bit lanes
+struct groupTables {
+  uchar length[256];
+  uchar shuffle[256][16] __attribute__((aligned(16)));
+  groupTables() {
+    for(int c=0;c<256;c++) {
+      int o = 0;
+      for(int i=0;i<4;i++) {
+	int len = ((c >> (2*i)) & 3) + 1;
+	for(int b=0;b<4;b++) shuffle[c][4*i+b] = (b < len) ? o+b : 0x80;
+	o += len;
+      }
+      length[c] = o;
+    }
+  }
+};
+
+//a template, so that the tables can be defined in this header; they
+//are built before main
+template <int dummy>
+struct groupTablesHolder { static groupTables T; };
+template <int dummy>
+groupTables groupTablesHolder<dummy>::T;
+
+/* Reads the first edge of an out-edge list, which is the signed
+   difference between the target and source. 
+*/
+inline intE eatWeight(uchar* &start) {
+  uchar fb = *start++;
+  intE edgeRead = (fb & 0x3f);
+  if (LAST_BIT_SET(fb)) {
+    int shiftAmount = 6;
+    while (1) {
+      uchar b = *start;
+      edgeRead |= ((b & 0x7f) << shiftAmount);
+      start++;
+      if (LAST_BIT_SET(b))
+        shiftAmount += EDGE_SIZE_PER_BYTE;
+      else 
+        break;
+    }
+  }
+  return (fb & 0x40) ? -edgeRead : edgeRead;
+}
+
+inline intE eatFirstEdge(uchar* &start, uintE source) {
+  uchar fb = *start++;
+  intE edgeRead = (fb & 0x3f);
+  if (LAST_BIT_SET(fb)) {
+    int shiftAmount = 6;
+    while (1) {
+      uchar b = *start;
+      edgeRead |= ((b & 0x7f) << shiftAmount);
+      start++;
+      if (LAST_BIT_SET(b))
+        shiftAmount += EDGE_SIZE_PER_BYTE;
+      else 
+        break;
+    }
+  }
+  return (fb & 0x40) ? source - edgeRead : source + edgeRead;
+}
+
+inline intE unZigZag(uintE x) { return (intE) ((x >> 1) ^ -(x & 1)); }
+inline uintE zigZag(intE x) { return ((uintE) x << 1) ^ (uintE) (x >> 31); }
+
+/*
+  Reads the k values of a group. With SSSE3, the 16 bytes after the
+  control byte are loaded at once; this can read past the end of the
+  last list, so the edge array must be followed by GROUP_PADDING bytes
+  (readGraph in IO.h allocates them). The unused control bits of a
+  partial group are 0, i.e. length 1, so the lengths of the values
+  that are not there are subtracted.
+*/
+inline void eatGroup(uchar* &start, uintE* values, long k) {
+  uchar c = *start++;
+#if defined(__SSSE3__)
+  const groupTables& T = groupTablesHolder<0>::T;
+  __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*) start),
+			       _mm_load_si128((__m128i*) T.shuffle[c]));
+  _mm_storeu_si128((__m128i*) values,v);
+  start += T.length[c] - (4-k);
+#else
+  for(long i=0;i<k;i++) {
+    int len = ((c >> (2*i)) & 3) + 1;
+    uintE v = 0;
+    for(int b=0;b<len;b++) v |= (uintE) start[b] << (8*b);
+    values[i] = v;
+    start += len;
+  }
+#endif
+}
+
+/*
+  Reads a group of k differences and turns them into edges by adding
+  them to prev (a prefix sum).
+*/
+inline void eatEdgeGroup(uchar* &start, uintE* edges, long k, uintE prev) {
+#if defined(__SSSE3__)
+  const groupTables& T = groupTablesHolder<0>::T;
+  uchar c = *start++;
+  __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*) start),
+			       _mm_load_si128((__m128i*) T.shuffle[c]));
+  v = _mm_add_epi32(v,_mm_slli_si128(v,4));
+  v = _mm_add_epi32(v,_mm_slli_si128(v,8));
+  v = _mm_add_epi32(v,_mm_set1_epi32(prev));
+  _mm_storeu_si128((__m128i*) edges,v);
+  start += T.length[c] - (4-k);
+#else
+  eatGroup(start,edges,k);
+  for(long i=0;i<k;i++) edges[i] = prev = prev + edges[i];
+#endif
+}
+
+/*
+  The main decoding work-horse. First eats the specially coded first 
+  edge, and then eats the remaining |d-1| many edges a group at a
+  time.
+*/
+template <class T, class F>
+  inline void decode(T t, F f, uchar* edgeStart, const uintE &source, const uintT &degree) {
+  if (degree > 0) {
+    uintE edge = eatFirstEdge(edgeStart,source);
+    if (!t.srcTarg(f, source, edge, 0)) return;
+    uintE edges[4];
+    long rest = degree-1;
+    uintT edgesRead = 1;
+    for(long g=0;g<rest;g+=4) {
+      long k = min<long>(4,rest-g);
+      eatEdgeGroup(edgeStart,edges,k,edge);
+      for(long i=0;i<k;i++)
+	if (!t.srcTarg(f, source, edges[i], edgesRead++)) return;
+      edge = edges[k-1];
+    }
+  }
+}
+
+//decode edges for weighted graph
+template <class T, class F>
+  inline void decodeWgh(T t, F f, uchar* edgeStart, const uintE &source, const uintT &degree) {
+  if (degree > 0) {
+    uintE edge = eatFirstEdge(edgeStart,source);
+    intE weight = eatWeight(edgeStart);
+    if (!t.srcTarg(f, source, edge, weight, 0)) return;
+    uintE edges[4], weights[4];
+    long rest = degree-1;
+    uintT edgesRead = 1;
+    for(long g=0;g<rest;g+=4) {
+      long k = min<long>(4,rest-g);
+      eatEdgeGroup(edgeStart,edges,k,edge);
+      eatGroup(edgeStart,weights,k);
+      for(long i=0;i<k;i++)
+	if (!t.srcTarg(f, source, edges[i], unZigZag(weights[i]), edgesRead++)) return;
+      edge = edges[k-1];
+    }
+  }
+}
+
+/*
+  Compresses the first edge, writing target-source and a sign bit. 
+*/
+long compressFirstEdge(uchar *start, long offset, uintE source, uintE target) {
+  intE preCompress = (intE) target - source;
+  uchar firstByte = 0;
+  intE toCompress = abs(preCompress);
+  firstByte = toCompress & 0x3f; // 0011|1111
+  if (preCompress < 0) {
+    firstByte |= 0x40;
+  }
+  toCompress = toCompress >> 6;
+  if (toCompress > 0) {
+    firstByte |= 0x80;
+  }
+  start[offset] = firstByte;
+  offset++;
+
+  uchar curByte = toCompress & 0x7f;
+  while ((curByte > 0) || (toCompress > 0)) {
+    uchar toWrite = curByte;
+    toCompress = toCompress >> 7;
+    // Check to see if there's any bits left to represent
+    curByte = toCompress & 0x7f;
+    if (toCompress > 0) {
+      toWrite |= 0x80; 
+    }
+    start[offset] = toWrite;
+    offset++;
+  }
+  return offset;
+}
+
+/*
+  Writes a group of k <= 4 values: the control byte, then each value
+  in as few bytes as possible.
+*/
+long compressGroup(uchar *start, long offset, uintE* values, long k) {
+  long controlOffset = offset++;
+  uchar control = 0;
+  for(long i=0;i<k;i++) {
+    uintE v = values[i];
+    int len = (v < (1 << 8)) ? 1 : (v < (1 << 16)) ? 2 : (v < (1 << 24)) ? 3 : 4;
+    control |= (len-1) << (2*i);
+    for(int b=0;b<len;b++) start[offset++] = (v >> (8*b)) & 0xff;
+  }
+  start[controlOffset] = control;
+  return offset;
+}
+
+/*
+  Takes: 
+    1. The edge array of chars to write into
+    2. The current offset into this array
+    3. The vertices degree
+    4. The vertices vertex number
+    5. The array of saved out-edges we're compressing
+  Returns:
+    The new offset into the edge array
+*/
+long sequentialCompressEdgeSet(uchar *edgeArray, long currentOffset, uintT degree, 
+                                uintE vertexNum, uintE *savedEdges) {
+  if (degree > 0) {
+    // Compress the first edge whole, which is signed difference coded
+    currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+                                       vertexNum, savedEdges[0]);
+    uintE differences[4];
+    for (uintT edgeI=1; edgeI < degree; edgeI+=4) {
+      long k = min<long>(4,degree-edgeI);
+      for(long i=0;i<k;i++)
+	differences[i] = savedEdges[edgeI+i] - savedEdges[edgeI+i-1];
+      currentOffset = compressGroup(edgeArray, currentOffset, differences, k);
+    }
+  }
+  return currentOffset;
+}
+
+/*
+  Compresses the edge set in parallel. 
+*/
+uintE *parallelCompressEdges(uintE *edges, uintT *offsets, long n, long m, uintE* Degrees) {
+  cout << "parallel compressing, (n,m) = (" << n << "," << m << ")" << endl;
+  uintE **edgePts = newA(uintE*, n);
+  uintT *degrees = newA(uintT, n+1);
+  long *charsUsedArr = newA(long, n);
+  long *compressionStarts = newA(long, n+1);
+  {parallel_for(long i=0; i<n; i++) { 
+      degrees[i] = Degrees[i];
+    charsUsedArr[i] = ceil((degrees[i] * 9) / 8) + 4;
+  }}
+  degrees[n] = 0;
+  sequence::plusScan(degrees,degrees, n+1);
+  long toAlloc = sequence::plusScan(charsUsedArr,charsUsedArr,n);
+  uintE* iEdges = newA(uintE,toAlloc);
+
+  {parallel_for(long i=0; i<n; i++) {
+      edgePts[i] = iEdges+charsUsedArr[i];
+      long charsUsed = 
+	sequentialCompressEdgeSet((uchar *)(iEdges+charsUsedArr[i]), 
+				  0, degrees[i+1]-degrees[i],
+				  i, edges + offsets[i]);
+      charsUsedArr[i] = charsUsed;
+  }}
+
+  // produce the total space needed for all compressed lists in chars. 
+  long totalSpace = sequence::plusScan(charsUsedArr, compressionStarts, n);
+  compressionStarts[n] = totalSpace;
+  free(degrees);
+  free(charsUsedArr);
+  
+  uchar *finalArr = newA(uchar, totalSpace);
+  cout << "total space requested is : " << totalSpace << endl;
+  float avgBitsPerEdge = (float)totalSpace*8 / (float)m; 
+  cout << "Average bits per edge: " << avgBitsPerEdge << endl;
+
+  {parallel_for(long i=0; i<n; i++) {
+      long o = compressionStarts[i];
+    memcpy(finalArr + o, (uchar *)(edgePts[i]), compressionStarts[i+1]-o);
+    offsets[i] = o;
+  }}
+  offsets[n] = totalSpace;
+  free(iEdges);
+  free(edgePts);
+  free(compressionStarts);
+  cout << "finished compressing, bytes used = " << totalSpace << endl;
+  cout << "would have been, " << (m * 4) << endl;
+  return ((uintE *)finalArr);
+}
+
+typedef pair<uintE,intE> intEPair;
+
+/*
+  Takes: 
+    1. The edge array of chars to write into
+    2. The current offset into this array
+    3. The vertices degree
+    4. The vertices vertex number
+    5. The array of saved out-edges we're compressing
+  Returns:
+    The new offset into the edge array
+*/
+long sequentialCompressWeightedEdgeSet
+(uchar *edgeArray, long currentOffset, uintT degree, 
+ uintE vertexNum, intEPair *savedEdges) {
+  if (degree > 0) {
+    // Compress the first edge whole, which is signed difference coded
+    //target ID
+    currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+                                       vertexNum, savedEdges[0].first);
+    //weight
+    currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+				      0,savedEdges[0].second);
+    uintE differences[4], weights[4];
+    for (uintT edgeI=1; edgeI < degree; edgeI+=4) {
+      long k = min<long>(4,degree-edgeI);
+      for(long i=0;i<k;i++) {
+	differences[i] = savedEdges[edgeI+i].first - savedEdges[edgeI+i-1].first;
+	weights[i] = zigZag(savedEdges[edgeI+i].second);
+      }
+      currentOffset = compressGroup(edgeArray, currentOffset, differences, k);
+      currentOffset = compressGroup(edgeArray, currentOffset, weights, k);
+    }
+  }
+  return currentOffset;
+}
+
+/*
+  Compresses the weighted edge set in parallel. 
+*/
+uchar *parallelCompressWeightedEdges(intEPair *edges, uintT *offsets, long n, long m, uintE* Degrees) {
+  cout << "parallel compressing, (n,m) = (" << n << "," << m << ")" << endl;
+  uintE **edgePts = newA(uintE*, n);
+  uintT *degrees = newA(uintT, n+1);
+  long *charsUsedArr = newA(long, n);
+  long *compressionStarts = newA(long, n+1);
+  {parallel_for(long i=0; i<n; i++) { 
+    degrees[i] = Degrees[i];
+    charsUsedArr[i] = 2*(ceil((degrees[i] * 9) / 8) + 4);
+  }}
+  degrees[n] = 0;
+  sequence::plusScan(degrees,degrees, n+1);
+  long toAlloc = sequence::plusScan(charsUsedArr,charsUsedArr,n);
+  uintE* iEdges = newA(uintE,toAlloc);
+
+  {parallel_for(long i=0; i<n; i++) {
+    edgePts[i] = iEdges+charsUsedArr[i];
+    long charsUsed = 
+      sequentialCompressWeightedEdgeSet((uchar *)(iEdges+charsUsedArr[i]), 0, degrees[i+1]-degrees[i],i, edges + offsets[i]);
+    charsUsedArr[i] = charsUsed;
+  }}
+
+  // produce the total space needed for all compressed lists in chars. 
+  long totalSpace = sequence::plusScan(charsUsedArr, compressionStarts, n);
+  compressionStarts[n] = totalSpace;
+  free(degrees);
+  free(charsUsedArr);
+
+  uchar *finalArr = newA(uchar, totalSpace);
+  cout << "total space requested is : " << totalSpace << endl;
+  float avgBitsPerEdge = (float)totalSpace*8 / (float)m; 
+  cout << "Average bits per edge: " << avgBitsPerEdge << endl;
+
+  {parallel_for(long i=0; i<n; i++) {
+      long o = compressionStarts[i];
+    memcpy(finalArr + o, (uchar *)(edgePts[i]), compressionStarts[i+1]-o);
+    offsets[i] = o;
+  }}
+  offsets[n] = totalSpace;
+  free(iEdges);
+  free(edgePts);
+  free(compressionStarts);
+  cout << "finished compressing, bytes used = " << totalSpace << endl;
+  cout << "would have been, " << (m * 8) << endl;
+  return finalArr;
+}
+
+#endif
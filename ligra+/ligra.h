@@ -24,24 +24,8 @@
 #ifndef LIGRA_PLUS_H
 #define LIGRA_PLUS_H
 
-//include the code for the desired compression scheme
-#ifndef PD 
-#ifdef BYTE
-#include "byte.h"
-#elif defined NIBBLE
-#include "nibble.h"
-#else
-#include "byteRLE.h"
-#endif
-#else //decode in parallel
-#ifdef BYTE
-#include "byte-pd.h"
-#elif defined NIBBLE
-#include "nibble-pd.h"
-#else
-#include "byteRLE-pd.h"
-#endif
-#endif
+//decoders for all compression schemes, selected by the file header
+#include "codecs.h"
 
 #include <iostream>
 #include <fstream>
@@ -55,6 +39,11 @@
 #include "graph.h"
 #include "IO.h"
 #include "parseCommandLine.h"
+#include "queryServer.h"
+#include "sparseMap.h"
+#include "worklist.h"
+#include "multiQueue.h"
+#include "edgeTiles.h"
 using namespace std;
 
 //*****START FRAMEWORK*****
@@ -142,14 +131,15 @@ vertexSubset(long _n, long _m, bool* bits)
 
 struct nonMaxF{bool operator() (const uintE &a) {return (a != UINT_E_MAX);}};
 
-//options to edgeMap for different versions of dense edgeMap (default is DENSE)
-enum options { DENSE, DENSE_FORWARD };
+//options to edgeMap for different versions of dense edgeMap (default
+//is DENSE); EDGE_STREAM uses the tiles of the graph (see edgeTiles.h)
+//if they were built, and DENSE otherwise
+enum options { DENSE, DENSE_FORWARD, EDGE_STREAM };
 
-//remove duplicate integers in [0,...,n-1]
+//remove duplicate integers in [0,...,n-1]; without flags, a hash
+//table of size O(m) is used instead
 void remDuplicates(uintE* indices, uintE* flags, long m, long n) {
-  //make flags for first time
-  if(flags == NULL) {flags = newA(uintE,n); 
-    {parallel_for(long i=0;i<n;i++) flags[i]=UINT_E_MAX;}}
+  if(flags == NULL) { remDuplicatesSparse(indices,m); return; }
   {parallel_for(uintE i=0;i<m;i++)
       if(indices[i] != UINT_E_MAX && flags[indices[i]] == UINT_E_MAX) 
 	CAS(&flags[indices[i]],(uintE)UINT_E_MAX,i);
@@ -166,8 +156,110 @@ void remDuplicates(uintE* indices, uintE* flags, long m, long n) {
   }
 }
 
+//*****DECODED LIST CACHE*****
+
+//applies t to a list in the cache, as decode does for compressed lists
+template <class T, class F>
+inline void decodeCached(T t, F f, uintE* list, const uintE &source, const uintT &degree) {
+  for(uintT j=0;j<degree;j++) {
+#ifdef WEIGHTED
+    if(!t.srcTarg(f, source, list[2*j], (intE) list[2*j+1], j)) return;
+#else
+    if(!t.srcTarg(f, source, list[j], j)) return;
+#endif
+  }
+}
+
+struct cacheT {
+  uintE* list;
+cacheT(uintE* _list) : list(_list) {}
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const uintT &edgeNumber) {
+    list[edgeNumber] = target;
+    return 1; }
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const intE &weight, const uintT &edgeNumber) {
+    list[2*edgeNumber] = target; list[2*edgeNumber+1] = weight;
+    return 1; }};
+
+//degree and list number
+typedef pair<uintT,uintT> listDegree;
+
+struct degreeGT {
+  bool operator() (const listDegree& a, const listDegree& b) {
+    return a.first > b.first; }};
+
+//Decodes the largest lists of GA into plain arrays, as many as fit in
+//budget bytes, which edgeMap then reads instead of decoding them again
+//in every call. On skewed graphs the few lists that fit hold most of
+//the edges. In- and out-lists compete for the same budget.
+template <class vertex>
+void cacheLists(graph<vertex>& GA, long budget) {
+  long n = GA.n;
+  bool symmetric = (sizeof(vertex) != sizeof(asymmetricVertex));
+#ifdef WEIGHTED
+  long wordsPerEdge = 2;
+#else
+  long wordsPerEdge = 1;
+#endif
+  //lists are numbered v (out-list of v) and n+v (in-list of v)
+  long numLists = symmetric ? n : 2*n;
+  listDegree* L = newA(listDegree,numLists);
+  {parallel_for(long i=0;i<n;i++) {
+      L[i] = make_pair(GA.V[i].getOutDegree(),(uintT)i);
+      if(!symmetric) L[n+i] = make_pair(GA.V[i].getInDegree(),(uintT)(n+i));
+    }}
+  quickSort(L,numLists,degreeGT());
+  //take the largest lists while they fit
+  long* starts = newA(long,numLists+1);
+  {parallel_for(long i=0;i<numLists;i++) starts[i] = L[i].first*wordsPerEdge;}
+  starts[numLists] = 0;
+  sequence::plusScan(starts,starts,numLists+1);
+  long budgetWords = budget/sizeof(uintE);
+  long k = upper_bound(starts,starts+numLists+1,budgetWords)-starts-1;
+  while(k > 0 && L[k-1].first == 0) k--;
+  //lay the chosen lists out in the order of their numbers, so that
+  //edgeMapDense reads them sequentially
+  {parallel_for(long i=0;i<=numLists;i++) starts[i] = 0;}
+  {parallel_for(long i=0;i<k;i++) starts[L[i].second] = L[i].first*wordsPerEdge;}
+  long words = sequence::plusScan(starts,starts,numLists+1), edges = words/wordsPerEdge;
+  uintE** outCache = newA(uintE*,n);
+  uintE** inCache = symmetric ? outCache : newA(uintE*,n);
+  {parallel_for(long i=0;i<n;i++) outCache[i] = inCache[i] = NULL;}
+  uintE* data = newA(uintE,max(words,(long)1));
+  {parallel_for(long i=0;i<k;i++) {
+      long v = L[i].second;
+      uintE* list = data+starts[v];
+      if(v < n) {
+	outCache[v] = list;
+#ifdef WEIGHTED
+	decodeWgh(GA.format,GA.outWeights,cacheT(list),0,GA.V[v].getOutNeighbors(),v,GA.V[v].getOutDegree());
+#else
+	decode(GA.format,cacheT(list),0,GA.V[v].getOutNeighbors(),v,GA.V[v].getOutDegree());
+#endif
+      } else {
+	v -= n;
+	inCache[v] = list;
+#ifdef WEIGHTED
+	decodeWgh(GA.format,GA.inWeights,cacheT(list),0,GA.V[v].getInNeighbors(),v,GA.V[v].getInDegree());
+#else
+	decode(GA.format,cacheT(list),0,GA.V[v].getInNeighbors(),v,GA.V[v].getInDegree());
+#endif
+      }
+    }}
+  free(L); free(starts);
+  if(GA.transposed) swap(inCache,outCache);
+  GA.outCache = outCache; GA.inCache = inCache; GA.cacheData = data;
+  cout << "cached " << k << " lists with " << edges << " edges ("
+       << (GA.m > 0 ? 100.0*edges/(symmetric ? GA.m : 2*GA.m) : 0)
+       << "%), " << words*sizeof(uintE) << " bytes" << endl;
+}
+
 //*****EDGE FUNCTIONS*****
 
+//The weighted srcTarg of these take the weight as a template so that a
+//weightRef (see graph.h) is only read if the update is applied.
+
 template <class F>
 struct denseT {
   bool* nextArr, *vertexArr;
@@ -176,7 +268,8 @@ denseT(bool* np, bool* vp) : nextArr(np), vertexArr(vp) {}
     if (vertexArr[target] && f.update(target, src)) nextArr[src] = 1;
     return f.cond(src);
   }
-  inline bool srcTarg(F f, const uintE &src, const uintE &target, const intE &weight, const uintT &edgeNumber) {
+  template <class W>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const W &weight, const uintT &edgeNumber) {
     if (vertexArr[target] && f.update(target, src, weight)) nextArr[src] = 1;
     return f.cond(src);
   }};
@@ -191,10 +284,13 @@ template <class F, class vertex>
     if (f.cond(i)) { 
 //      intT d = G[i].getInDegree();
       uchar *nghArr = G[i].getInNeighbors();
+      if(GA.inCache != NULL && GA.inCache[i] != NULL)
+	decodeCached(denseT<F>(next, vertexSubset), f, GA.inCache[i], i, G[i].getInDegree());
+      else
 #ifdef WEIGHTED
-      decodeWgh(denseT<F>(next, vertexSubset), f, nghArr, i, G[i].getInDegree());
+      decodeWgh(GA.format, GA.inWeights, denseT<F>(next, vertexSubset), f, nghArr, i, G[i].getInDegree());
 #else
-      decode(denseT<F>(next, vertexSubset), f, nghArr, i, G[i].getInDegree());
+      decode(GA.format, denseT<F>(next, vertexSubset), f, nghArr, i, G[i].getInDegree());
 #endif
     }
   }
@@ -209,7 +305,8 @@ denseForwardT(bool* np, bool* vp) : nextArr(np), vertexArr(vp) {}
     if (f.cond(target) && f.updateAtomic(src,target)) nextArr[target] = 1;
     return true;
   }
-  inline bool srcTarg(F f, const uintE &src, const uintE &target, const intE &weight, const uintT &edgeNumber) {
+  template <class W>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const W &weight, const uintT &edgeNumber) {
     if (f.cond(target) && f.updateAtomic(src,target, weight)) nextArr[target] = 1;
     return true;
   }};
@@ -224,10 +321,13 @@ template <class F, class vertex>
 //    intT d = G[i].getOutDegree();
       if(vertexSubset[i]) {
 	uchar *nghArr = G[i].getOutNeighbors();
+	if(GA.outCache != NULL && GA.outCache[i] != NULL)
+	  decodeCached(denseForwardT<F>(next, vertexSubset), f, GA.outCache[i], i, G[i].getOutDegree());
+	else
 #ifdef WEIGHTED
-	decodeWgh(denseForwardT<F>(next, vertexSubset), f, nghArr, i, G[i].getOutDegree());
+	decodeWgh(GA.format, GA.outWeights, denseForwardT<F>(next, vertexSubset), f, nghArr, i, G[i].getOutDegree());
 #else
-	decode(denseForwardT<F>(next, vertexSubset), f, nghArr, i, G[i].getOutDegree());
+	decode(GA.format, denseForwardT<F>(next, vertexSubset), f, nghArr, i, G[i].getOutDegree());
 #endif
       }
   }}
@@ -244,7 +344,8 @@ sparseT(uintT vP, uintT oP, uintE *outEdgesP) : v(vP), o(oP), outEdges(outEdgesP
       outEdges[o + edgeNumber] = target;
     else outEdges[o + edgeNumber] = UINT_E_MAX;
     return true; }
-  inline bool srcTarg(F f, const uintE &src, const uintE &target, const intE &weight, const uintT &edgeNumber) {
+  template <class W>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const W &weight, const uintT &edgeNumber) {
     if (f.cond(target) && f.updateAtomic(v, target, weight))
       outEdges[o + edgeNumber] = target;
     else outEdges[o + edgeNumber] = UINT_E_MAX;
@@ -253,7 +354,7 @@ sparseT(uintT vP, uintT oP, uintE *outEdgesP) : v(vP), o(oP), outEdges(outEdgesP
 
 
 template <class F, class vertex>
-pair<long,uintE*> edgeMapSparse(vertex* frontierVertices, uintE* indices, 
+pair<long,uintE*> edgeMapSparse(graph<vertex>& GA, vertex* frontierVertices, uintE* indices, 
 			       uintT* degrees, long m, F f,
 				long remDups=0, uintE* flags=NULL) {
   uintT* offsets = degrees;
@@ -266,10 +367,13 @@ pair<long,uintE*> edgeMapSparse(vertex* frontierVertices, uintE* indices,
 //    intT d = vert.getOutDegree();
     uchar *nghArr = vert.getOutNeighbors();
     // Decode, with src = v, and degree d, applying sparseT
+    if(GA.outCache != NULL && GA.outCache[v] != NULL)
+      decodeCached(sparseT<F>(v, o, outEdges), f, GA.outCache[v], v, vert.getOutDegree());
+    else
 #ifdef WEIGHTED
-    decodeWgh(sparseT<F>(v, o, outEdges), f, nghArr, v, vert.getOutDegree());
+    decodeWgh(GA.format, GA.outWeights, sparseT<F>(v, o, outEdges), f, nghArr, v, vert.getOutDegree());
 #else
-    decode(sparseT<F>(v, o, outEdges), f, nghArr, v, vert.getOutDegree());
+    decode(GA.format, sparseT<F>(v, o, outEdges), f, nghArr, v, vert.getOutDegree());
 #endif
   }
   uintE* nextIndices = newA(uintE, outEdgeCount);
@@ -311,7 +415,10 @@ template <class F, class vertex>
     V.toDense();
     free(degrees);
     free(frontierVertices);
-    bool* R = (option == DENSE_FORWARD) ? 
+    bool* R = (option == EDGE_STREAM && GA.tiles != NULL && 
+	       GA.tiles->transposed == GA.transposed) ?
+      edgeMapTiles(GA.tiles,V.d,f) :
+      (option == DENSE_FORWARD) ? 
       edgeMapDenseForward(GA,V.d,f) : 
       edgeMapDense(GA, V.d, f);
     vertexSubset v1 = vertexSubset(numVertices, R);
@@ -319,8 +426,8 @@ template <class F, class vertex>
   } else { 
     pair<long,uintE*> R = 
       remDups ? 
-      edgeMapSparse(frontierVertices, V.s, degrees, V.numNonzeros(), f,numVertices, GA.flags) :
-      edgeMapSparse(frontierVertices, V.s, degrees, V.numNonzeros(), f);
+      edgeMapSparse(GA, frontierVertices, V.s, degrees, V.numNonzeros(), f,numVertices, GA.flags) :
+      edgeMapSparse(GA, frontierVertices, V.s, degrees, V.numNonzeros(), f);
     //cout << "size (S) = " << R.first << endl;
     free(degrees);
     free(frontierVertices);
@@ -328,6 +435,163 @@ template <class F, class vertex>
   }
 }
 
+//adds the targets for which updateAtomic returns true to a scheduler
+template <class F, class S>
+struct asyncT {
+  S* Q;
+asyncT(S* _Q) : Q(_Q) {}
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const uintT &edgeNumber) {
+    if (f.cond(target) && f.updateAtomic(src, target)) Q->activate(target);
+    return true; }
+  template <class W>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const W &weight, const uintT &edgeNumber) {
+    if (f.cond(target) && f.updateAtomic(src, target, weight)) Q->activate(target);
+    return true; }};
+
+//Asynchronous edgeMap: processes the out-edges of the vertices of V and
+//of every vertex for which updateAtomic returns true, in the same call,
+//until no vertex is left. Vertices are taken from the scheduler W by
+//the next free worker, so updates propagate without waiting for a
+//round to end; W is a vertexWorklist (FIFO, see worklist.h) for
+//edgeMapAsync, or a multiQueue (by priority, see multiQueue.h).
+//updateAtomic must return true whenever it changed the value of d (not
+//only the first time in a round), since a vertex can be processed more
+//than once.
+//Returns the number of vertices added to W, or -1 if it became larger
+//than maxVisits (if not -1), in which case the values are not final.
+template <class F, class vertex, class S>
+long edgeMapScheduled(graph<vertex> GA, vertexSubset &V, F f, S &W, long maxVisits = -1) {
+  long n = GA.n;
+  vertex *G = GA.V;
+  if (n != V.numRows()) {
+    cout << "edgeMapScheduled: Sizes Don't match" << endl;
+    abort();
+  }
+  V.toSparse();
+  {parallel_for(long i=0;i<V.numNonzeros();i++) W.activate(V.s[i]);}
+  volatile bool stop = 0;
+  long P = getWorkers();
+  {parallel_for_1(long w=0;w<P;w++) {
+      uintE v;
+      while(!stop) {
+	if(W.next(v)) {
+	  vertex vert = G[v];
+	  if(GA.outCache != NULL && GA.outCache[v] != NULL)
+	    decodeCached(asyncT<F,S>(&W), f, GA.outCache[v], v, vert.getOutDegree());
+	  else
+#ifdef WEIGHTED
+	    decodeWgh(GA.format, GA.outWeights, asyncT<F,S>(&W), f, vert.getOutNeighbors(), v, vert.getOutDegree());
+#else
+	    decode(GA.format, asyncT<F,S>(&W), f, vert.getOutNeighbors(), v, vert.getOutDegree());
+#endif
+	  W.finish();
+	  if(maxVisits != -1 && W.added() > maxVisits) stop = 1;
+	} else if(W.done()) break;
+	else W.wait();
+      }
+    }}
+  return stop ? -1 : W.added();
+}
+
+//edgeMapScheduled with a FIFO queue, in which each vertex is at most
+//once at a time
+template <class F, class vertex>
+long edgeMapAsync(graph<vertex> GA, vertexSubset &V, F f, long maxVisits = -1) {
+  vertexWorklist W(GA.n);
+  long visits = edgeMapScheduled(GA,V,f,W,maxVisits);
+  W.del();
+  return visits;
+}
+
+//writes a decoded list to separate arrays of targets and weights
+struct tileListT {
+  uintE* D;
+  intE* W;
+tileListT(uintE* _D, intE* _W) : D(_D), W(_W) {}
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const uintT &edgeNumber) {
+    D[edgeNumber] = target;
+    return 1; }
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const intE &weight, const uintT &edgeNumber) {
+    D[edgeNumber] = target; W[edgeNumber] = weight;
+    return 1; }};
+
+//writes the out-edges of v for makeEdgeTiles
+template <class vertex>
+struct outEdgeListF {
+  graph<vertex>* GA;
+  outEdgeListF(graph<vertex>* _GA) : GA(_GA) {}
+  inline void operator() (uintE v, uintE* D, intE* W) {
+    vertex& vert = GA->V[v];
+    if(GA->outCache != NULL && GA->outCache[v] != NULL)
+      decodeCached(tileListT(D,W), 0, GA->outCache[v], v, vert.getOutDegree());
+    else
+#ifdef WEIGHTED
+      decodeWgh(GA->format, GA->outWeights, tileListT(D,W), 0, vert.getOutNeighbors(), v, vert.getOutDegree());
+#else
+      decode(GA->format, tileListT(D,W), 0, vert.getOutNeighbors(), v, vert.getOutDegree());
+#endif
+  }
+};
+
+//Builds the tiles of GA for the EDGE_STREAM option of edgeMap, from
+//its out-edges; they are used while GA is not transposed from the
+//direction it has now. logB is the log of the width of a range (by
+//default, see defaultTileBits). The tiles are not compressed.
+template <class vertex>
+void buildEdgeTiles(graph<vertex>& GA, long logB = -1) {
+  if(GA.tiles != NULL) { GA.tiles->del(); free(GA.tiles); }
+  if(logB < 0) logB = defaultTileBits(GA.n);
+  uintT* degrees = newA(uintT,GA.n);
+  {parallel_for(long i=0;i<GA.n;i++) degrees[i] = GA.V[i].getOutDegree();}
+#ifndef WEIGHTED
+  GA.tiles = makeEdgeTiles(GA.n,degrees,outEdgeListF<vertex>(&GA),false,logB);
+#else
+  GA.tiles = makeEdgeTiles(GA.n,degrees,outEdgeListF<vertex>(&GA),true,logB);
+#endif
+  GA.tiles->transposed = GA.transposed;
+  free(degrees);
+}
+
+//adds up A[target]; atomically for chunked lists, which are decoded
+//in parallel
+template <class T>
+struct sumT {
+  T* A, *sum;
+  bool atomic;
+sumT(T* _A, T* _sum, bool _atomic) : A(_A), sum(_sum), atomic(_atomic) {}
+  inline void add(const uintE &target) {
+    if(atomic) writeAdd(sum,A[target]);
+    else *sum += A[target];
+  }
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const uintT &edgeNumber) {
+    add(target);
+    return 1; }
+  template <class F, class W>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const W &weight, const uintT &edgeNumber) {
+    add(target);
+    return 1; }};
+
+//Returns the sum of A[u] over the in-neighbors u of v, for kernels
+//that gather over all in-edges (such as PageRank) and need no edgeMap
+//functor.
+template <class vertex, class T>
+inline T inNeighborSum(graph<vertex>& GA, uintE v, T* A) {
+  T sum = 0;
+  uintT d = GA.V[v].getInDegree();
+  if(GA.inCache != NULL && GA.inCache[v] != NULL)
+    decodeCached(sumT<T>(A,&sum,0), 0, GA.inCache[v], v, d);
+  else
+#ifdef WEIGHTED
+    decodeWgh(GA.format, GA.inWeights, sumT<T>(A,&sum,GA.format.chunk != 0), 0, GA.V[v].getInNeighbors(), v, d);
+#else
+    decode(GA.format, sumT<T>(A,&sum,GA.format.chunk != 0), 0, GA.V[v].getInNeighbors(), v, d);
+#endif
+  return sum;
+}
+
 //*****VERTEX FUNCTIONS*****
 
 //Note: this is the optimized version of vertexMap which does not
@@ -357,6 +621,43 @@ vertexSubset vertexFilter(vertexSubset V, F filter) {
   return vertexSubset(n,d_out);
 }
 
+//vertexFilter for a sparse V that only visits the vertices of V and
+//returns a sparse vertexSubset, so its cost is proportional to |V|
+//instead of n; a dense V is filtered with vertexFilter
+template <class F>
+vertexSubset vertexFilterSparse(vertexSubset& V, F filter) {
+  long n = V.numRows(), m = V.numNonzeros();
+  if(V.isDense) return vertexFilter(V,filter);
+  if(m == 0) return vertexSubset(n);
+  bool* keep = newA(bool,m);
+  {parallel_for(long i=0;i<m;i++) keep[i] = filter(V.s[i]);}
+  _seq<uintE> out = sequence::pack((uintE*) NULL,keep,(long) 0,m,sequence::getA<uintE,long>(V.s));
+  free(keep);
+  return vertexSubset(n,out.n,out.A);
+}
+
+//Declares that edgeMap functors read A[s] at the sources s of edges.
+//The distributed version (in ligra-mpi) sends these values to the
+//processes that need them; here it does nothing.
+template <class vertex, class T>
+inline void mirrorArray(graph<vertex>& GA, T* A) {}
+
+//With "-digest", apps print a digest of their result after each run,
+//so that builds can be compared: reportDigest(GA,P,A,f) prints
+//"digest = h", where h combines f(A[v]) over all vertices in order
+//(by default f(x) = x).
+struct digestValueF {
+  template <class T>
+  inline long operator() (T x) { return (long) x; }};
+
+template <class vertex, class T, class F = digestValueF>
+void reportDigest(graph<vertex>& GA, commandLine& P, T* A, F f = F()) {
+  if(!P.getOption("-digest")) return;
+  ulong h = 0;
+  for(long i=0;i<GA.n;i++) h = h*31+(ulong) f(A[i]);
+  cout << "digest = " << h << endl;
+}
+
 //Cond function that always returns true
 inline bool cond_true (const uintE &d) { return 1;}
 
@@ -365,13 +666,17 @@ void Compute(graph<vertex>&, commandLine);
 
 //driver
 int parallel_main(int argc, char* argv[]) {  
-  commandLine P(argc,argv," [-s] <inFile>");
+  commandLine P(argc,argv," [-s] [-cache <MB>] <inFile>");
   char* iFile = P.getArgument(0);
   bool symmetric = P.getOptionValue("-s");
   long rounds = P.getOptionLongValue("-rounds",3);
+  char* server = P.getOptionValue("-server");
+  long cache = P.getOptionLongValue("-cache",0) << 20;
   if(symmetric) {
     graph<symmetricVertex> G = 
       readGraph<symmetricVertex>(iFile,symmetric); //symmetric graph
+    if(cache > 0) cacheLists(G,cache);
+    if(server != NULL) { serveQueries(G,P,server,symmetric); G.del(); return 0; }
     Compute(G, P);
     for(int r=0;r<rounds;r++) {
       startTime();
@@ -382,6 +687,8 @@ int parallel_main(int argc, char* argv[]) {
   } else {
     graph<asymmetricVertex> G = 
       readGraph<asymmetricVertex>(iFile,symmetric); //asymmetric graph
+    if(cache > 0) cacheLists(G,cache);
+    if(server != NULL) { serveQueries(G,P,server,symmetric); G.del(); return 0; }
     Compute(G, P);
     if(G.transposed) G.transpose();
     for(int r=0;r<rounds;r++) {
@@ -26,18 +26,22 @@
 
 #if defined(CILK)
 #include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
 #define parallel_main main
 #define parallel_for cilk_for
 #define parallel_for_1 _Pragma("cilk_grainsize = 1") cilk_for
 #define parallel_for_256 _Pragma("cilk_grainsize = 256") cilk_for
+#define parallel_for_if(c) cilk_for
 
 // intel cilk+
 #elif defined(CILKP)
 #include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
 #define parallel_for cilk_for
 #define parallel_main main
 #define parallel_for_1 _Pragma("cilk grainsize = 1") cilk_for
 #define parallel_for_256 _Pragma("cilk grainsize = 256") cilk_for
+#define parallel_for_if(c) cilk_for
 
 // openmp
 #elif defined(OPENMP)
@@ -48,6 +52,9 @@
 #define parallel_for _Pragma("omp parallel for") for
 #define parallel_for_1 _Pragma("omp parallel for schedule (static,1)") for
 #define parallel_for_256 _Pragma("omp parallel for schedule (static,256)") for
+#define omp_pragma(x) _Pragma(#x)
+//runs the loop in parallel only if c is true
+#define parallel_for_if(c) omp_pragma(omp parallel for if(c)) for
 
 // c++
 #else
@@ -57,6 +64,7 @@
 #define parallel_for for
 #define parallel_for_1 for
 #define parallel_for_256 for
+#define parallel_for_if(c) for
 #define cilk_for for
 
 #endif
@@ -88,4 +96,15 @@ typedef unsigned int uintE;
 #define UINT_E_MAX UINT_MAX
 #endif
 
+//number of threads that parallel loops can run on
+inline long getWorkers() {
+#if defined(CILK) || defined(CILKP)
+  return __cilkrts_get_nworkers();
+#elif defined(OPENMP)
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
 #endif // _PARALLEL_H
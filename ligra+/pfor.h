@@ -0,0 +1,527 @@
+// This code is part of the project "Smaller and Faster: Parallel
+// Processing of Compressed Graphs with Ligra+", presented at the IEEE
+// Data Compression Conference, 2015.
+// Copyright (c) 2015 Julian Shun, Laxman Dhulipala and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Patched frame-of-reference (PFOR) code. The first edge of a list is
+// stored as in byte.h, as the signed difference from the source, and
+// the remaining differences, minus one, in blocks of PFOR_BLOCK. Each
+// block starts with a bit width b and a number of exceptions, followed
+// by the low b bits of each value, then the position of each exception
+// (a value wider than b bits) and its high bits as a varint. The
+// encoder picks the b that makes each block smallest. The values of a
+// full block are packed in four interleaved 32-bit lanes (value i in
+// lane i%4), so that with SSE2 four of them are unpacked at a time and
+// the prefix sum is vectorized; the last, partial block of a list is
+// packed in order. For weighted graphs, each block of differences is
+// followed by a block of the (zigzag coded) weights of those edges.
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <cmath>
+#include "parallel.h"
+#include "utils.h"
+#include <stdio.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(EDGELONG)
+#error "the PFOR code only supports 32-bit edges"
+#endif
+
+//a partial block is read a word at a time, which can go past the end
+//of the last list
+#ifndef GROUP_PADDING
+#define GROUP_PADDING 8
+#endif
+
+#define LAST_BIT_SET(b) (b & (0x80))
+#define EDGE_SIZE_PER_BYTE 7
+
+#define PFOR_BLOCK 128
+
+typedef unsigned char uchar;
+
+/* Reads the first edge of an out-edge list, which is the signed
+   difference between the target and source. 
+*/
+inline intE eatWeight(uchar* &start) {
+  uchar fb = *start++;
+  intE edgeRead = (fb & 0x3f);
+  if (LAST_BIT_SET(fb)) {
+    int shiftAmount = 6;
+    while (1) {
+      uchar b = *start;
+      edgeRead |= ((b & 0x7f) << shiftAmount);
+      start++;
+      if (LAST_BIT_SET(b))
+        shiftAmount += EDGE_SIZE_PER_BYTE;
+      else 
+        break;
+    }
+  }
+  return (fb & 0x40) ? -edgeRead : edgeRead;
+}
+
+inline intE eatFirstEdge(uchar* &start, uintE source) {
+  uchar fb = *start++;
+  intE edgeRead = (fb & 0x3f);
+  if (LAST_BIT_SET(fb)) {
+    int shiftAmount = 6;
+    while (1) {
+      uchar b = *start;
+      edgeRead |= ((b & 0x7f) << shiftAmount);
+      start++;
+      if (LAST_BIT_SET(b))
+        shiftAmount += EDGE_SIZE_PER_BYTE;
+      else 
+        break;
+    }
+  }
+  return (fb & 0x40) ? source - edgeRead : source + edgeRead;
+}
+
+inline intE unZigZag(uintE x) { return (intE) ((x >> 1) ^ -(x & 1)); }
+inline uintE zigZag(intE x) { return ((uintE) x << 1) ^ (uintE) (x >> 31); }
+
+inline uintE readBits(uchar* start, long bit, long b) {
+  ulong w;
+  memcpy(&w,start+(bit>>3),sizeof(ulong));
+  return (w >> (bit & 7)) & ((1UL << b)-1);
+}
+
+//bit j of value i of a full block, in the interleaved lanes
+inline long laneBit(long i, long j, long b) {
+  long lanePos = (i >> 2)*b+j;
+  return 128*(lanePos >> 5) + 32*(i & 3) + (lanePos & 31);
+}
+
+#if defined(__SSE2__)
+//unpacks the 16*b bytes of a full block of width b
+template <int b>
+inline void unpackLanes(uchar* in, uintE* out) {
+  __m128i* p = (__m128i*) in;
+  __m128i mask = _mm_set1_epi32(b == 32 ? 0xffffffff : (1U << b)-1);
+  __m128i w = _mm_loadu_si128(p++);
+  int shift = 0;
+  for(int i=0;i<PFOR_BLOCK/4;i++) {
+    __m128i v = _mm_srli_epi32(w,shift);
+    if(shift+b >= 32) {
+      //the last word is used up by the last value
+      if(i < PFOR_BLOCK/4-1) w = _mm_loadu_si128(p++);
+      if(shift+b > 32) v = _mm_or_si128(v,_mm_slli_epi32(w,32-shift));
+      shift = shift+b-32;
+    } else shift += b;
+    _mm_storeu_si128((__m128i*) out+i,_mm_and_si128(v,mask));
+  }
+}
+
+template <>
+inline void unpackLanes<0>(uchar* in, uintE* out) {
+  for(int i=0;i<PFOR_BLOCK/4;i++) _mm_storeu_si128((__m128i*) out+i,_mm_setzero_si128());
+}
+
+typedef void (*unpackFn)(uchar*, uintE*);
+
+template <int b>
+struct unpackers {
+  static void fill(unpackFn* T) { T[b] = unpackLanes<b>; unpackers<b-1>::fill(T); }
+};
+template <>
+struct unpackers<-1> { static void fill(unpackFn* T) {} };
+
+//unpackLanes for each width; a template, so that it can be defined in
+//this header
+struct unpackTable {
+  unpackFn f[33];
+  unpackTable() { unpackers<32>::fill(f); }
+};
+template <int dummy>
+struct unpackTableHolder { static unpackTable T; };
+template <int dummy>
+unpackTable unpackTableHolder<dummy>::T;
+#endif
+
+//reads a varint (7 bits per byte, low bits first)
+inline uintE eatVarint(uchar* &start) {
+  uintE x = 0;
+  int shift = 0;
+  while(1) {
+    uchar b = *start++;
+    x |= (uintE) (b & 0x7f) << shift;
+    if(!LAST_BIT_SET(b)) return x;
+    shift += EDGE_SIZE_PER_BYTE;
+  }
+}
+
+/*
+  Reads a block of k values: the width and the number of exceptions,
+  the low bits of each value, and the exceptions, which are patched
+  in.
+*/
+inline void eatBlock(uchar* &start, uintE* values, long k) {
+  long b = start[0], e = start[1];
+  start += 2;
+  if(k == PFOR_BLOCK) {
+#if defined(__SSE2__)
+    unpackTableHolder<0>::T.f[b](start,values);
+#else
+    for(long i=0;i<k;i++) {
+      uintE v = 0;
+      for(long j=0;j<b;j++) {
+	long bit = laneBit(i,j,b);
+	v |= (uintE) ((start[bit >> 3] >> (bit & 7)) & 1) << j;
+      }
+      values[i] = v;
+    }
+#endif
+    start += 16*b;
+  } else {
+    if(b == 0) for(long i=0;i<k;i++) values[i] = 0;
+    else for(long i=0;i<k;i++) values[i] = readBits(start,i*b,b);
+    start += (k*b+7)/8;
+  }
+  uchar* positions = start;
+  start += e;
+  for(long i=0;i<e;i++) values[positions[i]] |= eatVarint(start) << b;
+}
+
+/*
+  Reads a block of k differences and turns them into edges by adding
+  them (plus one) to prev.
+*/
+inline void eatEdgeBlock(uchar* &start, uintE* edges, long k, uintE prev) {
+  eatBlock(start,edges,k);
+#if defined(__SSE2__)
+  if(k == PFOR_BLOCK) {
+    __m128i one = _mm_set1_epi32(1), p = _mm_set1_epi32(prev);
+    for(long i=0;i<PFOR_BLOCK/4;i++) {
+      __m128i v = _mm_add_epi32(_mm_loadu_si128((__m128i*) edges+i),one);
+      v = _mm_add_epi32(v,_mm_slli_si128(v,4));
+      v = _mm_add_epi32(v,_mm_slli_si128(v,8));
+      v = _mm_add_epi32(v,p);
+      _mm_storeu_si128((__m128i*) edges+i,v);
+      p = _mm_shuffle_epi32(v,0xff);
+    }
+    return;
+  }
+#endif
+  for(long i=0;i<k;i++) edges[i] = prev = prev + edges[i] + 1;
+}
+
+/*
+  The main decoding work-horse. First eats the specially coded first 
+  edge, and then eats the remaining |d-1| many edges a block at a
+  time.
+*/
+template <class T, class F>
+  inline void decode(T t, F f, uchar* edgeStart, const uintE &source, const uintT &degree) {
+  if (degree > 0) {
+    uintE edge = eatFirstEdge(edgeStart,source);
+    if (!t.srcTarg(f, source, edge, 0)) return;
+    uintE edges[PFOR_BLOCK];
+    long rest = degree-1;
+    uintT edgesRead = 1;
+    for(long g=0;g<rest;g+=PFOR_BLOCK) {
+      long k = min<long>(PFOR_BLOCK,rest-g);
+      eatEdgeBlock(edgeStart,edges,k,edge);
+      for(long i=0;i<k;i++)
+	if (!t.srcTarg(f, source, edges[i], edgesRead++)) return;
+      edge = edges[k-1];
+    }
+  }
+}
+
+//decode edges for weighted graph
+template <class T, class F>
+  inline void decodeWgh(T t, F f, uchar* edgeStart, const uintE &source, const uintT &degree) {
+  if (degree > 0) {
+    uintE edge = eatFirstEdge(edgeStart,source);
+    intE weight = eatWeight(edgeStart);
+    if (!t.srcTarg(f, source, edge, weight, 0)) return;
+    uintE edges[PFOR_BLOCK], weights[PFOR_BLOCK];
+    long rest = degree-1;
+    uintT edgesRead = 1;
+    for(long g=0;g<rest;g+=PFOR_BLOCK) {
+      long k = min<long>(PFOR_BLOCK,rest-g);
+      eatEdgeBlock(edgeStart,edges,k,edge);
+      eatBlock(edgeStart,weights,k);
+      for(long i=0;i<k;i++)
+	if (!t.srcTarg(f, source, edges[i], unZigZag(weights[i]), edgesRead++)) return;
+      edge = edges[k-1];
+    }
+  }
+}
+
+/*
+  Compresses the first edge, writing target-source and a sign bit. 
+*/
+long compressFirstEdge(uchar *start, long offset, uintE source, uintE target) {
+  intE preCompress = (intE) target - source;
+  uchar firstByte = 0;
+  intE toCompress = abs(preCompress);
+  firstByte = toCompress & 0x3f; // 0011|1111
+  if (preCompress < 0) {
+    firstByte |= 0x40;
+  }
+  toCompress = toCompress >> 6;
+  if (toCompress > 0) {
+    firstByte |= 0x80;
+  }
+  start[offset] = firstByte;
+  offset++;
+
+  uchar curByte = toCompress & 0x7f;
+  while ((curByte > 0) || (toCompress > 0)) {
+    uchar toWrite = curByte;
+    toCompress = toCompress >> 7;
+    // Check to see if there's any bits left to represent
+    curByte = toCompress & 0x7f;
+    if (toCompress > 0) {
+      toWrite |= 0x80; 
+    }
+    start[offset] = toWrite;
+    offset++;
+  }
+  return offset;
+}
+
+inline long bitWidth(uintE x) { return x ? 32-__builtin_clz(x) : 0; }
+
+long compressVarint(uchar *start, long offset, uintE x) {
+  do {
+    uchar b = x & 0x7f;
+    x >>= EDGE_SIZE_PER_BYTE;
+    start[offset++] = x ? (b | 0x80) : b;
+  } while(x);
+  return offset;
+}
+
+/*
+  Writes a block of k <= PFOR_BLOCK values with the width that makes
+  it smallest: the packed low bits take 16*b bytes for a full block and
+  k*b/8 for a partial one, and each wider value also takes a position
+  byte and a varint of its high bits.
+*/
+long compressBlock(uchar *start, long offset, uintE* values, long k) {
+  long count[33];
+  for(long b=0;b<=32;b++) count[b] = 0;
+  for(long i=0;i<k;i++) count[bitWidth(values[i])]++;
+  long best = 32, bestSize = LONG_MAX;
+  for(long b=0;b<=32;b++) {
+    long size = (k == PFOR_BLOCK) ? 16*b : (k*b+7)/8;
+    for(long w=b+1;w<=32;w++) size += count[w]*(1+(w-b+EDGE_SIZE_PER_BYTE-1)/EDGE_SIZE_PER_BYTE);
+    if(size < bestSize) { bestSize = size; best = b; }
+  }
+  long b = best, e = 0;
+  for(long w=b+1;w<=32;w++) e += count[w];
+  start[offset++] = b;
+  start[offset++] = e;
+  long bytes = (k == PFOR_BLOCK) ? 16*b : (k*b+7)/8;
+  uchar* packed = start+offset;
+  memset(packed,0,bytes);
+  for(long i=0;i<k;i++) {
+    for(long j=0;j<b;j++) {
+      if(!((values[i] >> j) & 1)) continue;
+      long bit = (k == PFOR_BLOCK) ? laneBit(i,j,b) : i*b+j;
+      packed[bit >> 3] |= 1 << (bit & 7);
+    }
+  }
+  offset += bytes;
+  for(long i=0;i<k;i++) if(bitWidth(values[i]) > b) start[offset++] = i;
+  for(long i=0;i<k;i++) if(bitWidth(values[i]) > b) offset = compressVarint(start,offset,values[i] >> b);
+  return offset;
+}
+
+/*
+  Takes: 
+    1. The edge array of chars to write into
+    2. The current offset into this array
+    3. The vertices degree
+    4. The vertices vertex number
+    5. The array of saved out-edges we're compressing
+  Returns:
+    The new offset into the edge array
+*/
+long sequentialCompressEdgeSet(uchar *edgeArray, long currentOffset, uintT degree, 
+                                uintE vertexNum, uintE *savedEdges) {
+  if (degree > 0) {
+    // Compress the first edge whole, which is signed difference coded
+    currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+                                       vertexNum, savedEdges[0]);
+    uintE differences[PFOR_BLOCK];
+    for (uintT edgeI=1; edgeI < degree; edgeI+=PFOR_BLOCK) {
+      long k = min<long>(PFOR_BLOCK,degree-edgeI);
+      for(long i=0;i<k;i++)
+	differences[i] = savedEdges[edgeI+i] - savedEdges[edgeI+i-1] - 1;
+      currentOffset = compressBlock(edgeArray, currentOffset, differences, k);
+    }
+  }
+  return currentOffset;
+}
+
+/*
+  Compresses the edge set in parallel. 
+*/
+uintE *parallelCompressEdges(uintE *edges, uintT *offsets, long n, long m, uintE* Degrees) {
+  cout << "parallel compressing, (n,m) = (" << n << "," << m << ")" << endl;
+  uintE **edgePts = newA(uintE*, n);
+  uintT *degrees = newA(uintT, n+1);
+  long *charsUsedArr = newA(long, n);
+  long *compressionStarts = newA(long, n+1);
+  {parallel_for(long i=0; i<n; i++) { 
+      degrees[i] = Degrees[i];
+    charsUsedArr[i] = ceil((degrees[i] * 9) / 8) + 4;
+  }}
+  degrees[n] = 0;
+  sequence::plusScan(degrees,degrees, n+1);
+  long toAlloc = sequence::plusScan(charsUsedArr,charsUsedArr,n);
+  uintE* iEdges = newA(uintE,toAlloc);
+
+  {parallel_for(long i=0; i<n; i++) {
+      edgePts[i] = iEdges+charsUsedArr[i];
+      long charsUsed = 
+	sequentialCompressEdgeSet((uchar *)(iEdges+charsUsedArr[i]), 
+				  0, degrees[i+1]-degrees[i],
+				  i, edges + offsets[i]);
+      charsUsedArr[i] = charsUsed;
+  }}
+
+  // produce the total space needed for all compressed lists in chars. 
+  long totalSpace = sequence::plusScan(charsUsedArr, compressionStarts, n);
+  compressionStarts[n] = totalSpace;
+  free(degrees);
+  free(charsUsedArr);
+  
+  uchar *finalArr = newA(uchar, totalSpace);
+  cout << "total space requested is : " << totalSpace << endl;
+  float avgBitsPerEdge = (float)totalSpace*8 / (float)m; 
+  cout << "Average bits per edge: " << avgBitsPerEdge << endl;
+
+  {parallel_for(long i=0; i<n; i++) {
+      long o = compressionStarts[i];
+    memcpy(finalArr + o, (uchar *)(edgePts[i]), compressionStarts[i+1]-o);
+    offsets[i] = o;
+  }}
+  offsets[n] = totalSpace;
+  free(iEdges);
+  free(edgePts);
+  free(compressionStarts);
+  cout << "finished compressing, bytes used = " << totalSpace << endl;
+  cout << "would have been, " << (m * 4) << endl;
+  return ((uintE *)finalArr);
+}
+
+typedef pair<uintE,intE> intEPair;
+
+/*
+  Takes: 
+    1. The edge array of chars to write into
+    2. The current offset into this array
+    3. The vertices degree
+    4. The vertices vertex number
+    5. The array of saved out-edges we're compressing
+  Returns:
+    The new offset into the edge array
+*/
+long sequentialCompressWeightedEdgeSet
+(uchar *edgeArray, long currentOffset, uintT degree, 
+ uintE vertexNum, intEPair *savedEdges) {
+  if (degree > 0) {
+    // Compress the first edge whole, which is signed difference coded
+    //target ID
+    currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+                                       vertexNum, savedEdges[0].first);
+    //weight
+    currentOffset = compressFirstEdge(edgeArray, currentOffset, 
+				      0,savedEdges[0].second);
+    uintE differences[PFOR_BLOCK], weights[PFOR_BLOCK];
+    for (uintT edgeI=1; edgeI < degree; edgeI+=PFOR_BLOCK) {
+      long k = min<long>(PFOR_BLOCK,degree-edgeI);
+      for(long i=0;i<k;i++) {
+	differences[i] = savedEdges[edgeI+i].first - savedEdges[edgeI+i-1].first - 1;
+	weights[i] = zigZag(savedEdges[edgeI+i].second);
+      }
+      currentOffset = compressBlock(edgeArray, currentOffset, differences, k);
+      currentOffset = compressBlock(edgeArray, currentOffset, weights, k);
+    }
+  }
+  return currentOffset;
+}
+
+
+/*
+  Compresses the weighted edge set in parallel. 
+*/
+uchar *parallelCompressWeightedEdges(intEPair *edges, uintT *offsets, long n, long m, uintE* Degrees) {
+  cout << "parallel compressing, (n,m) = (" << n << "," << m << ")" << endl;
+  uintE **edgePts = newA(uintE*, n);
+  uintT *degrees = newA(uintT, n+1);
+  long *charsUsedArr = newA(long, n);
+  long *compressionStarts = newA(long, n+1);
+  {parallel_for(long i=0; i<n; i++) { 
+    degrees[i] = Degrees[i];
+    charsUsedArr[i] = 2*(ceil((degrees[i] * 9) / 8) + 4);
+  }}
+  degrees[n] = 0;
+  sequence::plusScan(degrees,degrees, n+1);
+  long toAlloc = sequence::plusScan(charsUsedArr,charsUsedArr,n);
+  uintE* iEdges = newA(uintE,toAlloc);
+
+  {parallel_for(long i=0; i<n; i++) {
+    edgePts[i] = iEdges+charsUsedArr[i];
+    long charsUsed = 
+      sequentialCompressWeightedEdgeSet((uchar *)(iEdges+charsUsedArr[i]), 0, degrees[i+1]-degrees[i],i, edges + offsets[i]);
+    charsUsedArr[i] = charsUsed;
+  }}
+
+  // produce the total space needed for all compressed lists in chars. 
+  long totalSpace = sequence::plusScan(charsUsedArr, compressionStarts, n);
+  compressionStarts[n] = totalSpace;
+  free(degrees);
+  free(charsUsedArr);
+
+  uchar *finalArr = newA(uchar, totalSpace);
+  cout << "total space requested is : " << totalSpace << endl;
+  float avgBitsPerEdge = (float)totalSpace*8 / (float)m; 
+  cout << "Average bits per edge: " << avgBitsPerEdge << endl;
+
+  {parallel_for(long i=0; i<n; i++) {
+      long o = compressionStarts[i];
+    memcpy(finalArr + o, (uchar *)(edgePts[i]), compressionStarts[i+1]-o);
+    offsets[i] = o;
+  }}
+  offsets[n] = totalSpace;
+  free(iEdges);
+  free(edgePts);
+  free(compressionStarts);
+  cout << "finished compressing, bytes used = " << totalSpace << endl;
+  cout << "would have been, " << (m * 8) << endl;
+  return finalArr;
+}
+
+#endif
@@ -0,0 +1,301 @@
+// This code is part of the project "Smaller and Faster: Parallel
+// Processing of Compressed Graphs with Ligra+", presented at the IEEE
+// Data Compression Conference, 2015.
+// Copyright (c) 2015 Julian Shun, Laxman Dhulipala and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Random access to compressed lists. With "-skip K" the encoder writes
+// a skip index after the edges of each direction: for every K-th edge
+// of a list its value and the position in the list where the edges
+// after it start (see skipEntry in graph.h). getOutNeighbor(G,v,j) and
+// hasEdge(G,u,v) then decode at most K edges from the nearest entry
+// (for PFOR, the entry points at the block of the next edge, so up to
+// K+PFOR_BLOCK). Lists that cannot be entered in the middle (byteRLE,
+// chunked lists and lists with inline weights), and graphs without an
+// index, are decoded from the start instead. Only included from
+// codecs.h.
+#ifndef SKIPINDEX_H
+#define SKIPINDEX_H
+
+//how a list can be decoded from a skip entry; pos is a byte offset
+//for SCAN_BYTE and SCAN_GROUPVARINT, a nibble offset for SCAN_NIBBLE,
+//an edge index for SCAN_RAW and SCAN_BITPACKED, and for SCAN_PFOR the
+//byte offset of the block that holds the next edge
+enum scanCode { SCAN_NONE, SCAN_RAW, SCAN_BYTE, SCAN_NIBBLE, SCAN_GROUPVARINT, SCAN_BITPACKED,
+		SCAN_PFOR };
+
+//Decodes a non-empty list one edge at a time, from its start or from
+//a skip entry.
+struct listScanner {
+  long code;
+  uchar* data;
+  uintE source, last;
+  uintT degree, j; //j is the index of the next edge
+  long pos, b; //b is the width of a bit-packed list
+  uintE group[4]; //the rest of the current group of a groupVarint list
+  long groupNext, groupSize;
+  uintE firstEdge; //of a bit-packed list
+#ifndef EDGELONG
+  //the differences in the current block of a PFOR list, which starts at
+  //byte blockStart (-1 if none has been read) and ends at blockEnd
+  uintE block[PFOR_BLOCK];
+  long blockStart, blockEnd, blockSize;
+#endif
+  listScanner(const compressionFormat& fmt, uchar* start, uintE _source, uintT _degree) :
+    code(SCAN_NONE), data(start), source(_source), last(0), degree(_degree), j(0),
+    pos(0), b(0), groupNext(0), groupSize(0) {
+    if(fmt.chunk != 0 || fmt.weights == WEIGHTS_INLINE || degree == 0) return;
+    switch(fmt.codec) {
+    case CODEC_BYTE: code = SCAN_BYTE; break;
+    case CODEC_NIBBLE: code = SCAN_NIBBLE; break;
+#ifndef EDGELONG
+    case CODEC_GROUPVARINT: code = SCAN_GROUPVARINT; break;
+    case CODEC_PFOR: code = SCAN_PFOR; blockStart = -1; break;
+#endif
+    case CODEC_ADAPTIVE:
+      data = start+1;
+      switch(start[0]) {
+      case LIST_RAW: code = SCAN_RAW; break;
+      case LIST_BYTE: code = SCAN_BYTE; break;
+      case LIST_NIBBLE: code = SCAN_NIBBLE; break;
+      case LIST_BITPACKED: code = SCAN_BITPACKED; break;
+      }
+    }
+    if(code == SCAN_BITPACKED) {
+      //the first edge and the width come before the packed differences
+      uchar* p = data;
+      firstEdge = byteCode::eatFirstEdge(p,source);
+      if(degree > 1) b = *p++;
+      data = p;
+    }
+  }
+
+  //returns edge j and moves to the next one
+  inline uintE next() {
+    uintE e;
+    switch(code) {
+    case SCAN_RAW:
+      memcpy(&e,data+sizeof(uintE)*j,sizeof(uintE));
+      pos = j+1;
+      break;
+    case SCAN_BYTE: {
+      uchar* p = data+pos;
+      e = (j == 0) ? byteCode::eatFirstEdge(p,source) : last+byteCode::eatEdge(p);
+      pos = p-data;
+      break; }
+    case SCAN_NIBBLE: {
+      uchar* p = data;
+      e = (j == 0) ? nibbleCode::decode_first_edge(p,&pos,source)
+	: last+nibbleCode::decode_next_edge(p,&pos);
+      break; }
+#ifndef EDGELONG
+    case SCAN_GROUPVARINT:
+      if(j == 0) {
+	uchar* p = data;
+	e = groupVarintCode::eatFirstEdge(p,source);
+	pos = p-data;
+      } else {
+	if(groupNext == groupSize) {
+	  uchar* p = data+pos;
+	  groupSize = min<long>(4,degree-j);
+	  groupVarintCode::eatEdgeGroup(p,group,groupSize,last);
+	  pos = p-data;
+	  groupNext = 0;
+	}
+	e = group[groupNext++];
+      }
+      break;
+#endif
+    case SCAN_BITPACKED:
+      e = (j == 0) ? firstEdge : last+bitPackedCode::readBits(data,(j-1)*b,b);
+      pos = j+1;
+      break;
+#ifndef EDGELONG
+    case SCAN_PFOR:
+      if(j == 0) {
+	uchar* p = data;
+	e = pforCode::eatFirstEdge(p,source);
+	pos = p-data;
+      } else {
+	long t = (j-1) % PFOR_BLOCK;
+	if(pos != blockStart) { //not the buffered block
+	  uchar* p = data+pos;
+	  blockSize = min<long>(PFOR_BLOCK,degree-j+t);
+	  pforCode::eatBlock(p,block,blockSize);
+	  blockStart = pos; blockEnd = p-data;
+	}
+	e = last+block[t]+1;
+	pos = (t == blockSize-1) ? blockEnd : blockStart;
+      }
+      break;
+#endif
+    default:
+      e = UINT_E_MAX;
+    }
+    j++;
+    return last = e;
+  }
+
+  //continues after edge i, whose skip entry is s
+  inline void seek(const skipEntry& s, uintT i) {
+    last = s.value; pos = s.pos; j = i+1;
+    groupNext = groupSize = 0;
+  }
+};
+
+//whether lists coded with fmt can be given a skip index (adaptive
+//lists also must not use byteRLE, see adaptiveCode::candidates)
+inline bool skippable(const compressionFormat& fmt) {
+  return fmt.chunk == 0 && fmt.weights != WEIGHTS_INLINE && fmt.codec != CODEC_BYTERLE;
+}
+
+//number of skip entries of a list of degree d
+inline long numSkipEntries(uintT d, long K) { return d > 0 ? (d-1)/K : 0; }
+
+//writes the skip entries of a list to S
+inline void buildListSkips(const compressionFormat& fmt, uchar* start, uintE source,
+			   uintT degree, skipEntry* S) {
+  long K = fmt.skip;
+  listScanner L(fmt,start,source,degree);
+  for(uintT j=0;j<degree;j++) {
+    uintE e = L.next();
+    if(j > 0 && j % K == 0) { S[j/K-1].value = e; S[j/K-1].pos = L.pos; }
+  }
+}
+
+//the skip index of the lists of vertices first..first+n-1, where the
+//list of first+i starts at edges+offsets[i]; sets numSkips to its length
+template <class OT>
+skipEntry* parallelBuildSkips(const compressionFormat& fmt, uchar* edges, OT* offsets,
+			      long first, long n, uintE* Degrees, long& numSkips) {
+  long* starts = newA(long,n+1);
+  {parallel_for(long i=0;i<n;i++) starts[i] = numSkipEntries(Degrees[i],fmt.skip);}
+  starts[n] = 0;
+  numSkips = sequence::plusScan(starts,starts,n+1);
+  skipEntry* S = newA(skipEntry,max(numSkips,(long)1));
+  {parallel_for(long i=0;i<n;i++)
+      buildListSkips(fmt,edges+offsets[i],first+i,Degrees[i],S+starts[i]);}
+  free(starts);
+  return S;
+}
+
+//for decoding lists that cannot be scanned from a skip entry
+struct nthNeighborT {
+  uintT j;
+  uintE* result;
+nthNeighborT(uintT _j, uintE* _result) : j(_j), result(_result) {}
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const uintT &edgeNumber) {
+    if(edgeNumber == j) *result = target;
+    return edgeNumber < j; }
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const intE &weight, const uintT &edgeNumber) {
+    if(edgeNumber == j) *result = target;
+    return edgeNumber < j; }};
+
+struct findNeighborT {
+  uintE v;
+  bool* found;
+findNeighborT(uintE _v, bool* _found) : v(_v), found(_found) {}
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const uintT &edgeNumber) {
+    if(target == v) *found = 1;
+    return target < v; }
+  template <class F>
+  inline bool srcTarg(F f, const uintE &src, const uintE &target, const intE &weight, const uintT &edgeNumber) {
+    if(target == v) *found = 1;
+    return target < v; }};
+
+//edge j of the list of source, whose skip entries are S (NULL if the
+//graph has no index)
+inline uintE listNeighbor(const compressionFormat& fmt, uchar* list, uintE source,
+			  uintT degree, skipEntry* S, uintT j) {
+  listScanner L(fmt,list,source,degree);
+  if(L.code == SCAN_NONE) {
+    uintE r = UINT_E_MAX;
+    if(fmt.weights == WEIGHTS_INLINE) decodeWgh(fmt,nthNeighborT(j,&r),0,list,source,degree);
+    else decode(fmt,nthNeighborT(j,&r),0,list,source,degree);
+    return r;
+  }
+  if(S != NULL && j >= fmt.skip) {
+    uintT s = j/fmt.skip-1, i = (s+1)*fmt.skip;
+    if(i == j) return S[s].value;
+    L.seek(S[s],i);
+  }
+  uintE e = L.next();
+  while(L.j <= j) e = L.next();
+  return e;
+}
+
+//whether v is in the (sorted) list of source
+inline bool listHasEdge(const compressionFormat& fmt, uchar* list, uintE source,
+			uintT degree, skipEntry* S, uintE v) {
+  if(degree == 0) return 0;
+  listScanner L(fmt,list,source,degree);
+  if(L.code == SCAN_NONE) {
+    bool found = 0;
+    if(fmt.weights == WEIGHTS_INLINE) decodeWgh(fmt,findNeighborT(v,&found),0,list,source,degree);
+    else decode(fmt,findNeighborT(v,&found),0,list,source,degree);
+    return found;
+  }
+  if(S != NULL) {
+    //find the last entry whose value is at most v
+    long lo = 0, hi = numSkipEntries(degree,fmt.skip);
+    while(lo < hi) {
+      long mid = (lo+hi)/2;
+      if(S[mid].value <= v) lo = mid+1; else hi = mid;
+    }
+    if(lo > 0) {
+      if(S[lo-1].value == v) return 1;
+      L.seek(S[lo-1],lo*fmt.skip);
+    }
+  }
+  while(L.j < degree) {
+    uintE e = L.next();
+    if(e >= v) return e == v;
+  }
+  return 0;
+}
+
+//*****GRAPH INTERFACE*****
+
+//j-th out-neighbor of v
+template <class vertex>
+inline uintE getOutNeighbor(graph<vertex>& G, uintE v, uintT j) {
+  return listNeighbor(G.format,G.V[v].getOutNeighbors(),v,G.V[v].getOutDegree(),
+		      G.outSkips == NULL ? NULL : G.outSkips+G.outSkipOffsets[v],j);
+}
+
+//j-th in-neighbor of v
+template <class vertex>
+inline uintE getInNeighbor(graph<vertex>& G, uintE v, uintT j) {
+  return listNeighbor(G.format,G.V[v].getInNeighbors(),v,G.V[v].getInDegree(),
+		      G.inSkips == NULL ? NULL : G.inSkips+G.inSkipOffsets[v],j);
+}
+
+//whether (u,v) is an edge
+template <class vertex>
+inline bool hasEdge(graph<vertex>& G, uintE u, uintE v) {
+  return listHasEdge(G.format,G.V[u].getOutNeighbors(),u,G.V[u].getOutDegree(),
+		     G.outSkips == NULL ? NULL : G.outSkips+G.outSkipOffsets[u],v);
+}
+
+#endif
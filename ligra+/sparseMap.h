@@ -0,0 +1,163 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Per-vertex values for local algorithms, which touch few vertices:
+// a concurrent open-addressing hash table from vertex IDs to values,
+// whose size is proportional to the number of keys instead of n.
+// M[v] returns a reference to the value of v (inserting v with the
+// empty value if needed), so functors written for an array A can take
+// a sparseMap instead, e.g. writeMin(&M[d],x). Keys are claimed with a
+// CAS and values are updated in place, so all operations can be called
+// concurrently; reserve and the functions that read the whole table
+// cannot. The table does not grow while keys are inserted, since other
+// threads may hold references to its values: it is sized for the keys
+// given to the constructor and to reserve, and inserting into a full
+// table aborts. Included from ligra.h.
+#ifndef SPARSE_MAP_H
+#define SPARSE_MAP_H
+#include "parallel.h"
+#include "utils.h"
+
+template <class V>
+struct sparseMap {
+  long mask;
+  long bound; //upper bound on the number of keys
+  uintE* keys; //UINT_E_MAX marks an empty slot
+  V* values;
+  V empty; //value of keys that are not in the map
+  //a map with room for size keys
+  sparseMap(long size, V _empty=V()) : bound(0), empty(_empty) { alloc(size); }
+
+  void alloc(long size) {
+    long capacity = 16;
+    while(capacity < 2*size) capacity *= 2;
+    mask = capacity-1;
+    keys = newA(uintE,capacity);
+    values = newA(V,capacity);
+    {parallel_for(long i=0;i<capacity;i++) { keys[i] = UINT_E_MAX; values[i] = empty; }}
+  }
+  void del() { free(keys); free(values); }
+  long capacity() { return mask+1; }
+
+  //slot of k; if k is not in the map it is inserted, and isNew is set
+  inline long slot(uintE k, bool* isNew=NULL) {
+    long start = hashInt(k) & mask, h = start;
+    while(1) {
+      uintE c = keys[h];
+      if(c == k) return h;
+      if(c == UINT_E_MAX) {
+	if(CAS(&keys[h],(uintE)UINT_E_MAX,k)) { if(isNew) *isNew = 1; return h; }
+	if(keys[h] == k) return h;
+      }
+      h = (h+1) & mask;
+      if(h == start) {
+	cout << "sparseMap: all " << capacity() << " slots are taken (more keys were "
+	     << "inserted than the map was created or reserved for)" << endl;
+	abort(); }
+    }
+  }
+  //value of k, or NULL if k is not in the map
+  inline V* find(uintE k) {
+    long start = hashInt(k) & mask, h = start;
+    uintE c;
+    while((c = keys[h]) != UINT_E_MAX) {
+      if(c == k) return &values[h];
+      h = (h+1) & mask;
+      if(h == start) break;
+    }
+    return NULL;
+  }
+  inline V get(uintE k) { V* v = find(k); return v ? *v : empty; }
+  inline V& operator[] (uintE k) { return values[slot(k)]; }
+  inline void update(uintE k, V v) { values[slot(k)] = v; }
+  //inserts k with value v, and returns true, if k is not in the map;
+  //v is only visible to other threads after the current round
+  inline bool insert(uintE k, V v) {
+    bool isNew = 0;
+    long h = slot(k,&isNew);
+    if(isNew) values[h] = v;
+    return isNew;
+  }
+  inline bool writeMin(uintE k, V v) { return ::writeMin(&values[slot(k)],v); }
+  //adds v to the value of k, and returns the old value
+  inline V writeAdd(uintE k, V v) {
+    V* a = &values[slot(k)];
+    volatile V newV, oldV;
+    do {oldV = *a; newV = oldV + v;}
+    while (!CAS(a, (V) oldV, (V) newV));
+    return oldV;
+  }
+
+  //number of keys
+  long size() {
+    long c = capacity();
+    long* count = newA(long,c);
+    {parallel_for(long i=0;i<c;i++) count[i] = (keys[i] != UINT_E_MAX);}
+    long r = sequence::plusReduce(count,c);
+    free(count);
+    return r;
+  }
+  //the keys, in no particular order
+  _seq<uintE> getKeys() {
+    uintE* A = newA(uintE,capacity());
+    long k = sequence::filter(keys,A,capacity(),nonMaxKeyF());
+    return _seq<uintE>(A,k);
+  }
+  struct nonMaxKeyF{bool operator() (uintE &a) {return (a != UINT_E_MAX);}};
+
+  //makes room for k more keys, growing the table if it could become
+  //more than half full; called between rounds with a bound on the keys
+  //the next round inserts (e.g. the out-degree of the frontier)
+  void reserve(long k) {
+    if(2*(bound+k) > capacity()) bound = size();
+    if(2*(bound+k) > capacity()) {
+      long oldCapacity = capacity();
+      uintE* oldKeys = keys;
+      V* oldValues = values;
+      alloc(2*(bound+k));
+      {parallel_for(long i=0;i<oldCapacity;i++)
+	  if(oldKeys[i] != UINT_E_MAX) values[slot(oldKeys[i])] = oldValues[i];}
+      free(oldKeys); free(oldValues);
+    }
+    bound += k;
+  }
+  //removes all keys
+  void clear() {
+    long c = capacity();
+    {parallel_for(long i=0;i<c;i++) { keys[i] = UINT_E_MAX; values[i] = empty; }}
+    bound = 0;
+  }
+};
+
+//Removes duplicates from indices[0..m-1] (entries equal to UINT_E_MAX
+//are ignored) with a table of size O(m), for edgeMaps on graphs without
+//flags. An entry is kept if it inserted its value into the table.
+inline void remDuplicatesSparse(uintE* indices, long m) {
+  sparseMap<bool> seen(m);
+  {parallel_for(long i=0;i<m;i++)
+      if(indices[i] != UINT_E_MAX && !seen.insert(indices[i],1)) indices[i] = UINT_E_MAX;}
+  seen.del();
+}
+
+#endif
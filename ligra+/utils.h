@@ -313,6 +313,14 @@ inline void writeAdd(ET *a, ET b) {
   while (!CAS(a, oldV, newV));
 }
 
+//atomically do bitwise-OR of *a with b and store in location a
+template <class ET>
+inline void writeOr(ET *a, ET b) {
+  volatile ET newV, oldV; 
+  do {oldV = *a; newV = oldV | b;}
+  while ((oldV != newV) && !CAS(a, oldV, newV));
+}
+
 inline uint hashInt(uint a) {
    a = (a+0x7ed55d16) + (a<<12);
    a = (a^0xc761c23c) ^ (a>>19);
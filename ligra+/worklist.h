@@ -0,0 +1,94 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Concurrent work queue of vertices for edgeMapAsync (in ligra.h). A
+// vertex is in the queue at most once: activate(v) adds it only if it
+// is not already waiting, and next(v) takes it out before it is
+// processed, so an update made to v while it is processed adds it
+// again. pending counts the vertices that were added but whose
+// processing has not finished (see finish), so the queue is done when
+// it is empty and pending is 0. Included from ligra.h.
+#ifndef WORKLIST_H
+#define WORKLIST_H
+#include <sched.h>
+#include "parallel.h"
+#include "utils.h"
+
+struct vertexWorklist {
+  long mask;
+  //positions of the next pop and push; they only increase, so tail is
+  //also the number of vertices ever added
+  volatile long head, tail;
+  volatile long pending;
+  //circular array of more than n slots; UINT_E_MAX marks an empty slot
+  volatile uintE* slots;
+  bool* queued;
+  vertexWorklist(long n) : head(0), tail(0), pending(0) {
+    long capacity = 2;
+    while(capacity <= n) capacity *= 2;
+    mask = capacity-1;
+    slots = newA(uintE,capacity);
+    queued = newA(bool,n);
+    {parallel_for(long i=0;i<capacity;i++) slots[i] = UINT_E_MAX;}
+    {parallel_for(long i=0;i<n;i++) queued[i] = 0;}
+  }
+  void del() { free((uintE*) slots); free(queued); }
+
+  //adds v if it is not in the queue; returns true if it was added
+  inline bool activate(uintE v) {
+    if(queued[v] || !CAS(&queued[v],(bool)0,(bool)1)) return 0;
+    __sync_fetch_and_add(&pending,1);
+    long t = __sync_fetch_and_add(&tail,1);
+    //a vertex that was popped from this slot may not be read yet
+    volatile uintE* s = &slots[t & mask];
+    while(*s != UINT_E_MAX) wait();
+    *s = v;
+    return 1;
+  }
+  //takes the next vertex from the queue, if there is one
+  inline bool next(uintE& v) {
+    long h;
+    do {
+      h = head;
+      if(h >= tail) return 0;
+    } while(!__sync_bool_compare_and_swap(&head,h,h+1));
+    //the vertex of a push that has taken this slot may not be written yet
+    volatile uintE* s = &slots[h & mask];
+    uintE x;
+    while((x = *s) == UINT_E_MAX) wait();
+    *s = UINT_E_MAX;
+    queued[x] = 0;
+    v = x;
+    return 1;
+  }
+  //called after a vertex returned by next has been processed
+  inline void finish() { __sync_fetch_and_add(&pending,-1); }
+  inline bool done() { return pending == 0; }
+  //called by workers that have nothing to do until other workers make
+  //progress, so that they do not take the processor from them
+  inline void wait() { sched_yield(); }
+  inline long added() { return tail; }
+};
+
+#endif
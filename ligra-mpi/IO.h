@@ -0,0 +1,260 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of 
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Reads a graph for the distributed version: each process reads the
+// out-edges of an equal share of the vertices, the vertices are split
+// into ranges with about the same number of edges, and the edges are
+// sent to the processes that own their targets (and, for asymmetric
+// graphs, their sources). With binary files (-b) each process reads
+// only its share; text files are read whole by every process.
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include "parallel.h"
+#include "quickSort.h"
+#include "comm.h"
+#include "graph.h"
+using namespace std;
+
+// A structure that keeps a sequence of strings all allocated from
+// the same block of memory
+struct words {
+  long n; // total number of characters
+  char* Chars;  // array storing all strings
+  long m; // number of substrings
+  char** Strings; // pointers to strings (all should be null terminated)
+  words() {}
+words(char* C, long nn, char** S, long mm)
+: Chars(C), n(nn), Strings(S), m(mm) {}
+  void del() {free(Chars); free(Strings);}
+};
+ 
+inline bool isSpace(char c) {
+  switch (c)  {
+  case '\r': 
+  case '\t': 
+  case '\n': 
+  case 0:
+  case ' ' : return true;
+  default : return false;
+  }
+}
+
+_seq<char> readStringFromFile(char *fileName) {
+  ifstream file (fileName, ios::in | ios::binary | ios::ate);
+  if (!file.is_open()) {
+    std::cout << "Unable to open file: " << fileName << std::endl;
+    abort();
+  }
+  long end = file.tellg();
+  file.seekg (0, ios::beg);
+  long n = end - file.tellg();
+  char* bytes = newA(char,n+1);
+  file.read (bytes,n);
+  file.close();
+  return _seq<char>(bytes,n);
+}
+
+// parallel code for converting a string to words
+words stringToWords(char *Str, long n) {
+  {parallel_for (long i=0; i < n; i++) 
+      if (isSpace(Str[i])) Str[i] = 0; }
+
+  // mark start of words
+  bool *FL = newA(bool,n);
+  FL[0] = Str[0];
+  {parallel_for (long i=1; i < n; i++) FL[i] = Str[i] && !Str[i-1];}
+    
+  // offset for each start of word
+  _seq<long> Off = sequence::packIndex<long>(FL, n);
+  long m = Off.n;
+  long *offsets = Off.A;
+
+  // pointer to each start of word
+  char **SA = newA(char*, m);
+  {parallel_for (long j=0; j < m; j++) SA[j] = Str+offsets[j];}
+
+  free(offsets); free(FL);
+  return words(Str,n,SA,m);
+}
+
+//the out-edges of the vertices [a,b), the share of this process, of a
+//graph with n vertices and m edges
+struct edgeChunk {
+  long n, m;
+  _seq<edgeRecord> E;
+};
+
+inline void shareOf(long n, long& a, long& b) {
+  a = (n*procRank)/numProcs;
+  b = (n*(procRank+1))/numProcs;
+}
+
+edgeChunk readChunkFromFile(char* fname) {
+  _seq<char> S = readStringFromFile(fname);
+  words W = stringToWords(S.A, S.n);
+#ifndef WEIGHTED
+  if (W.Strings[0] != (string) "AdjacencyGraph") {
+#else
+  if (W.Strings[0] != (string) "WeightedAdjacencyGraph") {
+#endif
+    cout << "Bad input file" << endl;
+    abort();
+  }
+
+  long len = W.m -1;
+  long n = atol(W.Strings[1]);
+  long m = atol(W.Strings[2]);
+#ifndef WEIGHTED
+  if (len != n + m + 2) {
+#else
+  if (len != n + 2*m + 2) {
+#endif
+    cout << "Bad input file" << endl;
+    abort();
+  }
+
+  long a, b;
+  shareOf(n,a,b);
+  long first = (a < n) ? atol(W.Strings[a+3]) : m;
+  long last = (b < n) ? atol(W.Strings[b+3]) : m;
+  edgeRecord* E = newA(edgeRecord,max(last-first,1L));
+  {parallel_for(long v=a;v<b;v++) {
+      long o = atol(W.Strings[v+3]), e = (v == n-1) ? m : atol(W.Strings[v+4]);
+      for(long i=o;i<e;i++) {
+	E[i-first].s = v;
+	E[i-first].d = atol(W.Strings[i+n+3]);
+#ifdef WEIGHTED
+	E[i-first].w = atol(W.Strings[i+n+m+3]);
+#endif
+      }
+    }}
+  W.del();
+  edgeChunk C = {n, m, _seq<edgeRecord>(E,last-first)};
+  return C;
+}
+
+edgeChunk readChunkFromBinary(char* iFile) {
+  char* config = (char*) ".config";
+  char* adj = (char*) ".adj";
+  char* idx = (char*) ".idx";
+  char configFile[strlen(iFile)+strlen(config)+1];
+  char adjFile[strlen(iFile)+strlen(adj)+1];
+  char idxFile[strlen(iFile)+strlen(idx)+1];
+  *configFile = *adjFile = *idxFile = '\0'; 
+  strcat(configFile,iFile);
+  strcat(adjFile,iFile);
+  strcat(idxFile,iFile);
+  strcat(configFile,config);
+  strcat(adjFile,adj);
+  strcat(idxFile,idx);
+
+  ifstream in(configFile, ifstream::in);
+  long n;
+  in >> n;
+  in.close();
+
+  ifstream in2(adjFile,ifstream::in | ios::binary); //stored as uints
+  in2.seekg(0, ios::end);
+  long m = in2.tellg()/sizeof(uint);
+
+  ifstream in3(idxFile,ifstream::in | ios::binary); //stored as longs
+  in3.seekg(0, ios::end);
+  if(n != in3.tellg()/sizeof(intT)) { cout << "File size wrong\n"; abort(); }
+
+  //offsets of the share of this process, and of the next vertex
+  long a, b;
+  shareOf(n,a,b);
+  uintT* offsets = newA(uintT,b-a+1);
+  in3.seekg(a*sizeof(uintT));
+  in3.read((char*) offsets,(min(b+1,n)-a)*sizeof(uintT));
+  in3.close();
+  if(b == n) offsets[b-a] = m;
+  long first = offsets[0], last = offsets[b-a];
+
+  uint* edges = newA(uint,max(last-first,1L));
+  in2.seekg(first*sizeof(uint));
+  in2.read((char*) edges,(last-first)*sizeof(uint));
+  in2.close();
+
+  edgeRecord* E = newA(edgeRecord,max(last-first,1L));
+  {parallel_for(long v=a;v<b;v++) {
+      for(long i=offsets[v-a];i<offsets[v-a+1];i++) {
+	E[i-first].s = v;
+	E[i-first].d = edges[i-first];
+#ifdef WEIGHTED
+	E[i-first].w = 1; //give them unit weight
+#endif
+      }
+    }}
+  free(offsets); free(edges);
+  edgeChunk C = {n, m, _seq<edgeRecord>(E,last-first)};
+  return C;
+}
+
+//sends the k edges of E to the owners of their targets, and builds the
+//local edges of this process from the edges it receives
+inline localEdges* distributeEdges(edgeRecord* E, long k, vertexPartition& part) {
+  quickSort(E,k,edgeTargetLT());
+  long* counts = newA(long,numProcs);
+  part.counts(E,k,targetKey(),counts);
+  _seq<edgeRecord> R = exchange(E,counts);
+  free(counts);
+  localEdges* L = makeLocalEdges(R.A,R.n,part);
+  R.del();
+  return L;
+}
+
+template <class vertex>
+graph<vertex> readGraph(char* iFile, bool symmetric, bool binary) {
+  edgeChunk C = binary ? readChunkFromBinary(iFile) : readChunkFromFile(iFile);
+  long n = C.n, m = C.m, k = C.E.n;
+  edgeRecord* E = C.E.A;
+  //the weight of a vertex is 1 plus the number of edges stored for it
+  long* W = newA(long,max(n,1L));
+  {parallel_for(long i=0;i<n;i++) W[i] = (procRank == 0);}
+  {parallel_for(long i=0;i<k;i++) {
+      writeAdd(&W[E[i].d],1L);
+      if(!symmetric) writeAdd(&W[E[i].s],1L);
+    }}
+  sumAll(W,n);
+  long total = sequence::plusScan(W,W,n);
+  vertexPartition part(n,W,total);
+  free(W);
+
+  localEdges* out = NULL;
+  if(!symmetric) {
+    //the edges of the transposed graph, by owner of their sources
+    edgeRecord* T = newA(edgeRecord,max(k,1L));
+    {parallel_for(long i=0;i<k;i++) {
+	T[i] = E[i];
+	T[i].s = E[i].d; T[i].d = E[i].s;
+      }}
+    out = distributeEdges(T,k,part);
+    free(T);
+  }
+  localEdges* in = distributeEdges(E,k,part);
+  C.E.del();
+  return graph<vertex>(n,m,part,in,out);
+}
@@ -0,0 +1,127 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of 
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Communication between the processes of the distributed version of
+// Ligra. Every process runs the same program on its own part of the
+// graph (see graph.h), and the functions here are called by all of
+// them at the same point. Arrays are sent as elements of a given size,
+// so counts are in elements and not bytes.
+#ifndef COMM_H
+#define COMM_H
+#include <mpi.h>
+#include <iostream>
+#include <stdlib.h>
+#include "parallel.h"
+#include "utils.h"
+using namespace std;
+
+//rank of this process and number of processes
+static int procRank = 0, numProcs = 1;
+
+inline void initProcesses(int* argc, char*** argv) {
+  int provided;
+  //only the main thread calls MPI
+  MPI_Init_thread(argc,argv,MPI_THREAD_FUNNELED,&provided);
+  MPI_Comm_rank(MPI_COMM_WORLD,&procRank);
+  MPI_Comm_size(MPI_COMM_WORLD,&numProcs);
+}
+
+inline void finishProcesses() { MPI_Finalize(); }
+
+inline void barrier() { MPI_Barrier(MPI_COMM_WORLD); }
+
+inline long sumAll(long x) {
+  long r;
+  MPI_Allreduce(&x,&r,1,MPI_LONG,MPI_SUM,MPI_COMM_WORLD);
+  return r;
+}
+
+//adds A[0..n-1] over all processes, in place
+inline void sumAll(long* A, long n) {
+  //in pieces, since counts are ints
+  for(long i=0;i<n;i+=(1L << 30))
+    MPI_Allreduce(MPI_IN_PLACE,A+i,(int) min(n-i,1L << 30),MPI_LONG,MPI_SUM,MPI_COMM_WORLD);
+}
+
+inline MPI_Datatype elementType(size_t size) {
+  MPI_Datatype t;
+  MPI_Type_contiguous((int) size,MPI_BYTE,&t);
+  MPI_Type_commit(&t);
+  return t;
+}
+
+inline int checkCount(long c) {
+  if(c > INT_MAX) { cout << "too many elements to send: " << c << endl; abort(); }
+  return (int) c;
+}
+
+//Sends sendCounts[p] elements to each process p, taken in order from
+//A (the elements for process 0 first). Returns the elements received,
+//ordered by sender, and sets recvCounts[p] to the number from p if
+//recvCounts is not NULL.
+inline _seq<char> exchange(char* A, long* sendCounts, size_t size, long* recvCounts = NULL) {
+  int P = numProcs;
+  int* sc = newA(int,P), *rc = newA(int,P), *sd = newA(int,P), *rd = newA(int,P);
+  for(int p=0;p<P;p++) sc[p] = checkCount(sendCounts[p]);
+  MPI_Alltoall(sc,1,MPI_INT,rc,1,MPI_INT,MPI_COMM_WORLD);
+  long sOff = 0, rOff = 0;
+  for(int p=0;p<P;p++) {
+    sd[p] = checkCount(sOff); rd[p] = checkCount(rOff);
+    sOff += sc[p]; rOff += rc[p];
+    if(recvCounts != NULL) recvCounts[p] = rc[p];
+  }
+  char* R = newA(char,max(rOff,1L)*size);
+  MPI_Datatype t = elementType(size);
+  MPI_Alltoallv(A,sc,sd,t,R,rc,rd,t,MPI_COMM_WORLD);
+  MPI_Type_free(&t);
+  free(sc); free(rc); free(sd); free(rd);
+  return _seq<char>(R,rOff);
+}
+
+template <class E>
+_seq<E> exchange(E* A, long* sendCounts, long* recvCounts = NULL) {
+  _seq<char> R = exchange((char*) A,sendCounts,sizeof(E),recvCounts);
+  return _seq<E>((E*) R.A,R.n);
+}
+
+//Concatenates the n elements of A of every process, in order of
+//rank, into R (which has room for all of them), and sets counts[p] to
+//the number from p if counts is not NULL.
+inline void gatherAll(char* A, long n, size_t size, char* R, long* counts = NULL) {
+  int P = numProcs;
+  int* c = newA(int,P), *d = newA(int,P);
+  int myCount = checkCount(n);
+  MPI_Allgather(&myCount,1,MPI_INT,c,1,MPI_INT,MPI_COMM_WORLD);
+  long off = 0;
+  for(int p=0;p<P;p++) {
+    d[p] = checkCount(off); off += c[p];
+    if(counts != NULL) counts[p] = c[p];
+  }
+  MPI_Datatype t = elementType(size);
+  MPI_Allgatherv(A,myCount,t,R,c,d,t,MPI_COMM_WORLD);
+  MPI_Type_free(&t);
+  free(c); free(d);
+}
+
+#endif
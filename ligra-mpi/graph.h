@@ -0,0 +1,253 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of 
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Distributed graph. The vertices are split into ranges, one per
+// process, and each process stores the in-edges of the vertices of its
+// range, so that updates only write to local vertices. The sources of
+// these edges that belong to other processes are its mirrors. Arrays
+// of per-vertex values (e.g. the IDs of Components) are allocated with
+// all n entries on every process, so the apps index them as before;
+// the entries of a process's own vertices are current, and the entries
+// of its mirrors are refreshed by edgeMap when they are in the frontier
+// (see mirrorArray in ligra.h).
+#ifndef GRAPH_H
+#define GRAPH_H
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include "parallel.h"
+#include "utils.h"
+#include "comm.h"
+#include "quickSort.h"
+using namespace std;
+
+//The vertex type of a graph only says whether it is symmetric; the
+//edges are kept in localEdges
+struct symmetricVertex {};
+struct asymmetricVertex {};
+
+//an edge, as read and sent to the process that stores it
+struct edgeRecord {
+  uintE s, d;
+#ifdef WEIGHTED
+  intE w;
+#endif
+};
+
+struct edgeTargetLT {
+  bool operator() (const edgeRecord& a, const edgeRecord& b) {
+    return a.d < b.d || (a.d == b.d && a.s < b.s); }};
+
+struct edgeSourceLT {
+  bool operator() (const edgeRecord& a, const edgeRecord& b) {
+    return a.s < b.s || (a.s == b.s && a.d < b.d); }};
+
+//Ranges of vertices of the processes: p has [starts[p],starts[p+1]).
+//Ranges start at multiples of 64, so that bitmaps over the ranges of
+//all processes can be concatenated.
+struct vertexPartition {
+  long n;
+  long* starts;
+  vertexPartition() : n(0), starts(NULL) {}
+  //ranges with about the same total weight, where W[v] is the weight
+  //of the vertices before v
+  vertexPartition(long _n, long* W, long total) : n(_n) {
+    int P = numProcs;
+    starts = newA(long,P+1);
+    starts[0] = 0; starts[P] = n;
+    for(int p=1;p<P;p++) {
+      long target = (total*p)/P;
+      long v = lower_bound(W,W+n,target)-W;
+      v = (v/64)*64;
+      starts[p] = max(starts[p-1],min(v,n));
+    }
+  }
+  void del() { free(starts); }
+  inline long lo(int p) { return starts[p]; }
+  inline long hi(int p) { return starts[p+1]; }
+  //process whose range contains v
+  inline int owner(uintE v) {
+    return upper_bound(starts,starts+numProcs+1,(long) v)-starts-1;
+  }
+  //number of elements of A[0..m-1], sorted by their vertex key(e),
+  //that belong to each process
+  template <class E, class K>
+  void counts(E* A, long m, K key, long* C) {
+    long prev = 0;
+    for(int p=0;p<numProcs;p++) {
+      long l = prev, r = m;
+      while(l < r) {
+	long mid = (l+r)/2;
+	if((long) key(A[mid]) < starts[p+1]) l = mid+1; else r = mid;
+      }
+      C[p] = l-prev; prev = l;
+    }
+  }
+};
+
+struct targetKey { uintE operator() (const edgeRecord& e) { return e.d; }};
+struct identityKey { uintE operator() (const uintE& v) { return v; }};
+
+//The edges whose targets are the local vertices [lo,hi), indexed by
+//target for dense edgeMaps and by source for sparse ones.
+struct localEdges {
+  long lo, hi, m;
+  //in-edges of local vertex v: sources[offsets[v-lo]..offsets[v-lo+1]-1]
+  long* offsets;
+  uintE* sources;
+  //the distinct sources, sorted, and the targets of the edges of
+  //mirrors[i]: targets[mirrorOffsets[i]..mirrorOffsets[i+1]-1]
+  long numMirrors;
+  uintE* mirrors;
+  long* mirrorOffsets;
+  uintE* targets;
+#ifdef WEIGHTED
+  intE* inWeights, *outWeights;
+#endif
+  //the processes on which local vertex v is a mirror, which are sent
+  //its values: ranks[rankOffsets[v-lo]..rankOffsets[v-lo+1]-1]
+  long* rankOffsets;
+  int* ranks;
+
+  inline long inDegree(uintE v) { return offsets[v-lo+1]-offsets[v-lo]; }
+  //index of v in mirrors, or -1
+  inline long findMirror(uintE v) {
+    uintE* p = lower_bound(mirrors,mirrors+numMirrors,v);
+    return (p != mirrors+numMirrors && *p == v) ? p-mirrors : -1;
+  }
+  void del() {
+    free(offsets); free(sources); free(mirrors); free(mirrorOffsets); free(targets);
+#ifdef WEIGHTED
+    free(inWeights); free(outWeights);
+#endif
+    free(rankOffsets); free(ranks);
+  }
+};
+
+//Builds the localEdges of this process from the m edges E, whose
+//targets are all local. Called by all processes, since each tells the
+//owners of its mirrors about them.
+inline localEdges* makeLocalEdges(edgeRecord* E, long m, vertexPartition& part) {
+  localEdges* L = newA(localEdges,1);
+  long lo = L->lo = part.lo(procRank), hi = L->hi = part.hi(procRank), k = hi-lo;
+  L->m = m;
+  //by target
+  quickSort(E,m,edgeTargetLT());
+  L->offsets = newA(long,k+1);
+  {parallel_for(long i=0;i<=k;i++) {
+      edgeRecord key; key.d = lo+i; key.s = 0;
+      L->offsets[i] = lower_bound(E,E+m,key,edgeTargetLT())-E;
+    }}
+  L->sources = newA(uintE,m);
+#ifdef WEIGHTED
+  L->inWeights = newA(intE,m);
+  L->outWeights = newA(intE,m);
+#endif
+  {parallel_for(long i=0;i<m;i++) {
+      L->sources[i] = E[i].s;
+#ifdef WEIGHTED
+      L->inWeights[i] = E[i].w;
+#endif
+    }}
+  //by source
+  quickSort(E,m,edgeSourceLT());
+  bool* first = newA(bool,max(m,1L));
+  {parallel_for(long i=0;i<m;i++) first[i] = (i == 0 || E[i].s != E[i-1].s);}
+  _seq<long> starts = sequence::packIndex<long>(first,m);
+  free(first);
+  long M = L->numMirrors = starts.n;
+  L->mirrors = newA(uintE,max(M,1L));
+  L->mirrorOffsets = newA(long,M+1);
+  L->targets = newA(uintE,m);
+  {parallel_for(long i=0;i<M;i++) {
+      L->mirrorOffsets[i] = starts.A[i];
+      L->mirrors[i] = E[starts.A[i]].s;
+    }}
+  L->mirrorOffsets[M] = m;
+  starts.del();
+  {parallel_for(long i=0;i<m;i++) {
+      L->targets[i] = E[i].d;
+#ifdef WEIGHTED
+      L->outWeights[i] = E[i].w;
+#endif
+    }}
+
+  //tell the owners of the mirrors, which are sorted by owner
+  long* sendCounts = newA(long,numProcs), *recvCounts = newA(long,numProcs);
+  part.counts(L->mirrors,M,identityKey(),sendCounts);
+  _seq<uintE> R = exchange(L->mirrors,sendCounts,recvCounts);
+  L->rankOffsets = newA(long,k+1);
+  {parallel_for(long i=0;i<=k;i++) L->rankOffsets[i] = 0;}
+  for(long i=0;i<R.n;i++) L->rankOffsets[R.A[i]-lo]++;
+  sequence::plusScan(L->rankOffsets,L->rankOffsets,k+1);
+  L->ranks = newA(int,max(R.n,1L));
+  long* pos = newA(long,k);
+  {parallel_for(long i=0;i<k;i++) pos[i] = L->rankOffsets[i];}
+  for(long p=0,i=0;p<numProcs;p++)
+    for(long j=0;j<recvCounts[p];j++,i++) L->ranks[pos[R.A[i]-lo]++] = p;
+  free(pos); R.del(); free(sendCounts); free(recvCounts);
+  return L;
+}
+
+//used to check that edgeTiles (see buildEdgeTiles in ligra.h) are
+//never built in this version
+struct edgeTiles;
+
+//per-vertex array whose values at mirrors are sent by edgeMap
+struct mirroredArray {
+  char* A;
+  size_t size; //bytes per vertex
+};
+
+template <class vertex>
+struct graph {
+  long n, m;
+  vertexPartition part;
+  //edges of the local vertices, and for asymmetric graphs the edges
+  //from them, indexed as the in-edges of the transposed graph
+  localEdges* in, *out;
+  uintE* flags;
+  bool transposed;
+  edgeTiles* tiles; //always NULL
+  vector<mirroredArray>* mirrored;
+  graph(long nn, long mm, vertexPartition _part, localEdges* _in, localEdges* _out)
+  : n(nn), m(mm), part(_part), in(_in), out(_out), flags(NULL), transposed(false), tiles(NULL) {
+    mirrored = new vector<mirroredArray>();
+  }
+  bool symmetric() { return out == NULL; }
+  //out-degree of local vertex v in the whole graph
+  inline long outDegree(uintE v) { return symmetric() ? in->inDegree(v) : out->inDegree(v); }
+  void transpose() {
+    if(!symmetric()) { swap(in,out); transposed = !transposed; }
+  }
+  void del() {
+    if(flags != NULL) free(flags);
+    in->del(); free(in);
+    if(out != NULL) { out->del(); free(out); }
+    part.del();
+    delete mirrored;
+  }
+};
+#endif
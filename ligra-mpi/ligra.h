@@ -0,0 +1,551 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of 
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Distributed version of Ligra, over MPI. Every process runs the
+// application on the same input, and the graph (graph.h) and
+// vertexSubsets are split by vertex ranges: a process stores the
+// in-edges of its own vertices, and a vertexSubset holds only its own
+// members, while numNonzeros() is the total over all processes. Before
+// each edgeMap the frontier vertices are sent to the processes that
+// have edges from them, with alltoallv when the frontier is sparse and
+// as a bitmap gathered by every process when it is dense, together
+// with their values in the arrays given to mirrorArray. updates then
+// only write to local vertices. Apps whose updates write to the source
+// (e.g. BC and MIS) or that read vertex data directly (GA.V) are not
+// supported. All functions that return a vertexSubset must be called
+// by all processes.
+#ifndef LIGRA_H
+#define LIGRA_H
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include "parallel.h"
+#include "gettime.h"
+#include "utils.h"
+#include "comm.h"
+#include "graph.h"
+#include "IO.h"
+#include "parseCommandLine.h"
+#include "multiQueue.h"
+using namespace std;
+
+//*****START FRAMEWORK*****
+
+//range of the vertices of this process, set when the graph is read
+static long localLo = 0, localHi = 0;
+
+//The range of a process is empty on graphs with few vertices, so the
+//local arrays can have length 0, which the sequence functions below
+//do not take: reduce reads the first element, and packIndex wraps
+//around for an unsigned index type.
+
+//number of true entries of d[0..k-1]
+inline long localCount(bool* d, long k) { return (k == 0) ? 0 : sequence::sum(d,k); }
+
+//indices of the true entries of d[0..k-1]
+inline _seq<uintE> localIndices(bool* d, long k) {
+  if(k == 0) return _seq<uintE>(newA(uintE,1),0);
+  return sequence::packIndex<uintE>(d,k);
+}
+
+//*****VERTEX OBJECT*****
+struct vertexSubset {
+  long n, m; //m counts the vertices of all processes
+  long lo, hi, mLocal;
+  uintE* s; //the local vertices in the subset
+  bool* d; //d[v-lo] for local vertices v
+  bool isDense;
+
+  //empty vertex set
+vertexSubset(long _n) : n(_n), m(0), lo(localLo), hi(localHi), mLocal(0), 
+    s(NULL), d(NULL), isDense(0) {}
+  // make a singleton vertex in range of n
+vertexSubset(long _n, intE v) 
+: n(_n), m(1), lo(localLo), hi(localHi), d(NULL), isDense(0) {
+  mLocal = isLocal(v);
+  s = newA(uintE,1);
+  s[0] = v;
+}
+  // make vertexSubset from array of vertex indices, the same on all
+  // processes; n is range, and m is size of array
+vertexSubset(long _n, long _m, uintE* indices) 
+: n(_n), m(_m), lo(localLo), hi(localHi), d(NULL), isDense(0) {
+  s = newA(uintE,max(_m,1L));
+  mLocal = sequence::filter(indices,s,_m,localF(lo,hi));
+  free(indices);
+}
+  // make vertexSubset from boolean array, where n is range
+vertexSubset(long _n, bool* bits) 
+: n(_n), lo(localLo), hi(localHi), s(NULL), isDense(1) {
+  d = localPart(bits);
+  mLocal = localCount(d,hi-lo);
+  m = sumAll(mLocal); }
+  // make vertexSubset from boolean array giving number of true values
+vertexSubset(long _n, long _m, bool* bits) 
+: n(_n), m(_m), lo(localLo), hi(localHi), s(NULL), isDense(1) {
+  d = localPart(bits);
+  mLocal = localCount(d,hi-lo); }
+
+  struct localF {
+    long lo, hi;
+    localF(long _lo, long _hi) : lo(_lo), hi(_hi) {}
+    bool operator() (uintE v) { return v >= lo && v < hi; }};
+  inline bool isLocal(uintE v) { return v >= lo && v < hi; }
+  bool* localPart(bool* bits) {
+    bool* r = newA(bool,max(hi-lo,1L));
+    {parallel_for(long i=0;i<hi-lo;i++) r[i] = bits[lo+i];}
+    free(bits);
+    return r;
+  }
+
+  // delete the contents
+  void del(){
+    if (d != NULL) free(d);
+    if (s != NULL) free(s);
+  }
+  long numRows() { return n; }
+  long numNonzeros() { return m; }
+  bool isEmpty() { return m==0; }
+
+  // converts to dense but keeps sparse representation if there
+  void toDense() {
+    if (d == NULL) {
+      d = newA(bool,max(hi-lo,1L));
+      {parallel_for(long i=0;i<hi-lo;i++) d[i] = 0;}
+      {parallel_for(long i=0;i<mLocal;i++) d[s[i]-lo] = 1;}
+    }
+    isDense = true;
+  }
+
+  // converts to sparse but keeps dense representation if there
+  void toSparse() {
+    if (s == NULL) {
+      _seq<uintE> R = localIndices(d,hi-lo);
+      {parallel_for(long i=0;i<R.n;i++) R.A[i] += lo;}
+      s = R.A;
+    }
+    isDense = false;
+  }
+};
+
+//vertexSubsets of local vertices, e.g. the output of edgeMap
+inline vertexSubset localSubset(long n, long mLocal, uintE* s) {
+  vertexSubset V(n);
+  V.s = s; V.mLocal = mLocal; V.m = sumAll(mLocal);
+  return V;
+}
+
+inline vertexSubset localSubset(long n, bool* d) {
+  vertexSubset V(n);
+  V.d = d; V.isDense = 1;
+  V.mLocal = localCount(d,V.hi-V.lo); V.m = sumAll(V.mLocal);
+  return V;
+}
+
+struct nonMaxF{bool operator() (uintE &a) {return (a != UINT_E_MAX);}};
+
+//options to edgeMap for different versions of dense edgeMap (default
+//is DENSE); there are no edge tiles in this version, so EDGE_STREAM
+//is the same as DENSE
+enum options { DENSE, DENSE_FORWARD, EDGE_STREAM};
+
+//*****MIRRORS*****
+
+//Declares that edgeMap functors read A[s] at the sources s of edges, so
+//that the values of the frontier vertices are sent to the processes
+//that have edges from them before each edgeMap. Arrays only read or
+//written at targets need not be declared. The declarations are
+//cleared after each call to Compute.
+template <class vertex, class T>
+void mirrorArray(graph<vertex>& GA, T* A) {
+  mirroredArray a = {(char*) A, sizeof(T)};
+  GA.mirrored->push_back(a);
+}
+
+//There is no query server (see ligra/queryServer.h), so apps have no
+//query answer to write to
+template <class T>
+inline void answerVertexValues(T* A, long n, T none) {}
+
+//Makes all n entries of A current on every process, e.g. to print
+//the results of an application
+template <class vertex, class T>
+void gatherVertexArray(graph<vertex>& GA, T* A) {
+  T* R = newA(T,max(GA.n,1L));
+  gatherAll((char*) (A+localLo),localHi-localLo,sizeof(T),(char*) R);
+  {parallel_for(long i=0;i<GA.n;i++) A[i] = R[i];}
+  free(R);
+}
+
+inline bool inFrontier(ulong* bits, uintE v) { return (bits[v/64] >> (v%64)) & 1; }
+
+//Gathers the dense frontier V of all processes as a bitmap, and the
+//values of its vertices in the mirrored arrays. Values are written
+//only to the entries of other processes' vertices.
+template <class vertex>
+ulong* sendDense(graph<vertex>& GA, vertexSubset& V) {
+  long n = GA.n, lo = V.lo, hi = V.hi, numWords = (n+63)/64, myWords = (hi-lo+63)/64;
+  ulong* mine = newA(ulong,max(myWords,1L));
+  {parallel_for(long w=0;w<myWords;w++) {
+      ulong word = 0;
+      for(long i=w*64;i<min(hi-lo,(w+1)*64);i++) if(V.d[i]) word |= 1UL << (i%64);
+      mine[w] = word;
+    }}
+  ulong* bits = newA(ulong,max(numWords,1L));
+  gatherAll((char*) mine,myWords,sizeof(ulong),(char*) bits);
+  free(mine);
+  vector<mirroredArray>& M = *GA.mirrored;
+  if(M.size() == 0) return bits;
+
+  //the values are gathered in order of vertex, so the position of the
+  //values of v is the number of frontier vertices before v
+  long* before = newA(long,numWords+1);
+  {parallel_for(long w=0;w<numWords;w++) before[w] = __builtin_popcountl(bits[w]);}
+  before[numWords] = 0;
+  sequence::plusScan(before,before,numWords+1);
+  _seq<uintE> local = localIndices(V.d,hi-lo);
+  for(long a=0;a<M.size();a++) {
+    char* A = M[a].A;
+    size_t size = M[a].size;
+    char* buffer = newA(char,max(local.n,1L)*size);
+    {parallel_for(long i=0;i<local.n;i++)
+	memcpy(buffer+i*size,A+(lo+local.A[i])*size,size);}
+    char* R = newA(char,max(V.m,1L)*size);
+    gatherAll(buffer,local.n,size,R);
+    {parallel_for(long w=0;w<numWords;w++) {
+	ulong word = bits[w];
+	while(word) {
+	  long b = __builtin_ctzl(word);
+	  long v = w*64+b;
+	  if(v < lo || v >= hi)
+	    memcpy(A+v*size,R+(before[w]+__builtin_popcountl(bits[w] & ((1UL << b)-1)))*size,size);
+	  word &= word-1;
+	}
+      }}
+    free(buffer); free(R);
+  }
+  local.del(); free(before);
+  return bits;
+}
+
+//Sends each vertex of the sparse frontier V, with its values in the
+//mirrored arrays, to the processes on which it is a mirror, and
+//returns the frontier vertices received.
+template <class vertex>
+_seq<uintE> sendSparse(graph<vertex>& GA, vertexSubset& V) {
+  localEdges* L = GA.in;
+  vector<mirroredArray>& M = *GA.mirrored;
+  long lo = V.lo, hi = V.hi, k = V.mLocal, P = numProcs;
+  size_t recordSize = sizeof(uintE);
+  for(long a=0;a<M.size();a++) recordSize += M[a].size;
+  long* counts = newA(long,P);
+  for(long p=0;p<P;p++) counts[p] = 0;
+  {parallel_for(long i=0;i<k;i++) {
+      uintE v = V.s[i];
+      for(long j=L->rankOffsets[v-lo];j<L->rankOffsets[v-lo+1];j++)
+	writeAdd(&counts[L->ranks[j]],1L);
+    }}
+  long* pos = newA(long,P);
+  long total = sequence::plusScan(counts,pos,P);
+  char* buffer = newA(char,max(total,1L)*recordSize);
+  {parallel_for(long i=0;i<k;i++) {
+      uintE v = V.s[i];
+      for(long j=L->rankOffsets[v-lo];j<L->rankOffsets[v-lo+1];j++) {
+	char* r = buffer+__sync_fetch_and_add(&pos[L->ranks[j]],1)*recordSize;
+	memcpy(r,&v,sizeof(uintE));
+	r += sizeof(uintE);
+	for(long a=0;a<M.size();a++) {
+	  memcpy(r,M[a].A+v*M[a].size,M[a].size);
+	  r += M[a].size;
+	}
+      }
+    }}
+  _seq<char> R = exchange(buffer,counts,recordSize);
+  free(buffer); free(counts); free(pos);
+  uintE* sources = newA(uintE,max(R.n,1L));
+  {parallel_for(long i=0;i<R.n;i++) {
+      char* r = R.A+i*recordSize;
+      uintE v;
+      memcpy(&v,r,sizeof(uintE));
+      sources[i] = v;
+      r += sizeof(uintE);
+      for(long a=0;a<M.size();a++) {
+	if(v < lo || v >= hi) memcpy(M[a].A+v*M[a].size,r,M[a].size);
+	r += M[a].size;
+      }
+    }}
+  long numSources = R.n;
+  R.del();
+  return _seq<uintE>(sources,numSources);
+}
+
+//*****EDGE FUNCTIONS*****
+template <class F, class vertex>
+bool* edgeMapDense(graph<vertex>& GA, vertexSubset& V, F f) {
+  ulong* bits = sendDense(GA,V);
+  localEdges* L = GA.in;
+  long lo = L->lo, k = L->hi-L->lo;
+  bool* next = newA(bool,max(k,1L));
+  {parallel_for (long i=0; i<k; i++){
+    next[i] = 0;
+    uintE v = lo+i;
+    if (f.cond(v)) { 
+      for(long j=L->offsets[i]; j<L->offsets[i+1]; j++){
+	uintE ngh = L->sources[j];
+#ifndef WEIGHTED
+	if (inFrontier(bits,ngh) && f.update(ngh,v))
+#else
+	if (inFrontier(bits,ngh) && f.update(ngh,v,L->inWeights[j]))
+#endif
+	  next[i] = 1;
+	if(!f.cond(v)) break;
+      }
+    }
+    }}
+  free(bits);
+  return next;
+}
+
+template <class F, class vertex>
+bool* edgeMapDenseForward(graph<vertex>& GA, vertexSubset& V, F f) {
+  ulong* bits = sendDense(GA,V);
+  localEdges* L = GA.in;
+  long lo = L->lo, k = L->hi-L->lo;
+  bool* next = newA(bool,max(k,1L));
+  {parallel_for(long i=0;i<k;i++) next[i] = 0;}
+  {parallel_for(long i=0;i<L->numMirrors;i++){
+    uintE s = L->mirrors[i];
+    if (inFrontier(bits,s)) {
+      for(long j=L->mirrorOffsets[i]; j<L->mirrorOffsets[i+1]; j++){
+	uintE ngh = L->targets[j];
+#ifndef WEIGHTED
+	if (f.cond(ngh) && f.updateAtomic(s,ngh))
+#else
+	if (f.cond(ngh) && f.updateAtomic(s,ngh,L->outWeights[j]))
+#endif
+	  next[ngh-lo] = 1;
+      }
+    }
+    }}
+  free(bits);
+  return next;
+}
+
+template <class F, class vertex>
+_seq<uintE> edgeMapSparse(graph<vertex>& GA, vertexSubset& V, F f, bool remDups) {
+  _seq<uintE> S = sendSparse(GA,V);
+  localEdges* L = GA.in;
+  long lo = L->lo, k = S.n;
+  long* mirror = newA(long,max(k,1L)), *offsets = newA(long,k+1);
+  {parallel_for(long i=0;i<k;i++) {
+      mirror[i] = L->findMirror(S.A[i]);
+      offsets[i] = L->mirrorOffsets[mirror[i]+1]-L->mirrorOffsets[mirror[i]];
+    }}
+  offsets[k] = 0;
+  long outEdgeCount = sequence::plusScan(offsets,offsets,k+1);
+  uintE* outEdges = newA(uintE,max(outEdgeCount,1L));
+  {parallel_for(long i=0;i<k;i++) {
+      uintE s = S.A[i];
+      long o = offsets[i]-L->mirrorOffsets[mirror[i]];
+      for(long j=L->mirrorOffsets[mirror[i]]; j<L->mirrorOffsets[mirror[i]+1]; j++){
+	uintE ngh = L->targets[j];
+#ifndef WEIGHTED
+	if(f.cond(ngh) && f.updateAtomic(s,ngh))
+#else
+	if(f.cond(ngh) && f.updateAtomic(s,ngh,L->outWeights[j]))
+#endif
+	  outEdges[o+j] = ngh;
+	else outEdges[o+j] = UINT_E_MAX;
+      }
+    }}
+  free(mirror); free(offsets); S.del();
+  if(remDups) {
+    //targets are local, so they are marked in an array of the range
+    long r = L->hi-lo;
+    bool* flags = newA(bool,max(r,1L));
+    {parallel_for(long i=0;i<r;i++) flags[i] = 0;}
+    {parallel_for(long i=0;i<outEdgeCount;i++)
+	if(outEdges[i] != UINT_E_MAX && (flags[outEdges[i]-lo] || 
+					 !CAS(&flags[outEdges[i]-lo],(bool)0,(bool)1)))
+	  outEdges[i] = UINT_E_MAX;}
+    free(flags);
+  }
+  uintE* nextIndices = newA(uintE,max(outEdgeCount,1L));
+  long nextM = sequence::filter(outEdges,nextIndices,outEdgeCount,nonMaxF());
+  free(outEdges);
+  return _seq<uintE>(nextIndices,nextM);
+}
+
+// decides on sparse or dense base on number of nonzeros in the active
+// vertices of all processes
+template <class F, class vertex>
+vertexSubset edgeMap(graph<vertex> GA, vertexSubset &V, F f, intT threshold = -1, 
+		 char option=DENSE, bool remDups=false) {
+  long numVertices = GA.n, numEdges = GA.m;
+  if(threshold == -1) threshold = numEdges/20; //default threshold
+  if (numVertices != V.numRows()) {
+    cout << "edgeMap: Sizes Don't match" << endl;
+    abort();
+  }
+  V.toSparse();
+  long k = V.mLocal;
+  long* degrees = newA(long,max(k,1L));
+  {parallel_for(long i=0;i<k;i++) degrees[i] = GA.outDegree(V.s[i]);}
+  long outDegrees = sumAll((k == 0) ? 0 : sequence::plusReduce(degrees,k));
+  free(degrees);
+  if (outDegrees == 0) return vertexSubset(numVertices);
+  if (V.m + outDegrees > threshold) { 
+    V.toDense();
+    bool* R = (option == DENSE_FORWARD) ? 
+      edgeMapDenseForward(GA,V,f) : 
+      edgeMapDense(GA,V,f);
+    return localSubset(numVertices,R);
+  } else { 
+    _seq<uintE> R = edgeMapSparse(GA,V,f,remDups);
+    return localSubset(numVertices,R.n,R.A);
+  }
+}
+
+//Runs edgeMaps from V, and then from their outputs, until no vertex is
+//left; in this version updates are not applied asynchronously, but
+//the result is the same, since updateAtomic returns true every time it
+//changes the value of a target. Returns the number of vertices
+//processed, or -1 if it became larger than maxVisits (if not -1).
+template <class F, class vertex>
+long edgeMapAsync(graph<vertex> GA, vertexSubset &V, F f, long maxVisits = -1) {
+  long visits = V.numNonzeros();
+  vertexSubset Frontier = edgeMap(GA,V,f,-1,DENSE,true);
+  while(!Frontier.isEmpty()) {
+    visits += Frontier.numNonzeros();
+    if(maxVisits != -1 && visits > maxVisits) { Frontier.del(); return -1; }
+    vertexSubset output = edgeMap(GA,Frontier,f,-1,DENSE,true);
+    Frontier.del();
+    Frontier = output;
+  }
+  Frontier.del();
+  return visits;
+}
+
+//the scheduler W is not used in this version (see edgeMapAsync)
+template <class F, class vertex, class S>
+long edgeMapScheduled(graph<vertex> GA, vertexSubset &V, F f, S &W, long maxVisits = -1) {
+  return edgeMapAsync(GA,V,f,maxVisits);
+}
+
+//edge tiles are not built in this version: the dense edgeMap of each
+//process already reads only the in-edges of its own range
+template <class vertex>
+void buildEdgeTiles(graph<vertex>& GA, long logB = -1) {}
+
+//*****VERTEX FUNCTIONS*****
+
+//applies add to the local vertices of V
+template <class F>
+void vertexMap(vertexSubset V, F add) {
+  long lo = V.lo;
+  if(V.isDense) {
+    {parallel_for(long i=0;i<V.hi-lo;i++)
+	if(V.d[i]) add(lo+i);}
+  } else {
+    {parallel_for(long i=0;i<V.mLocal;i++)
+	add(V.s[i]);}
+  }
+}
+
+template <class F>
+vertexSubset vertexFilter(vertexSubset V, F filter) {
+  long lo = V.lo, k = V.hi-V.lo;
+  V.toDense();
+  bool* d_out = newA(bool,max(k,1L));
+  {parallel_for(long i=0;i<k;i++) d_out[i] = 0;}
+  {parallel_for(long i=0;i<k;i++)
+      if(V.d[i]) d_out[i] = filter(lo+i);}
+  return localSubset(V.n,d_out);
+}
+
+//With "-digest", apps print a digest of their result after each run,
+//so that builds can be compared: reportDigest(GA,P,A,f) prints
+//"digest = h", where h combines f(A[v]) over all vertices in order
+//(by default f(x) = x). A is gathered first, and the digest is
+//printed by process 0.
+struct digestValueF {
+  template <class T>
+  inline long operator() (T x) { return (long) x; }};
+
+template <class vertex, class T, class F = digestValueF>
+void reportDigest(graph<vertex>& GA, commandLine& P, T* A, F f = F()) {
+  if(!P.getOption("-digest")) return;
+  gatherVertexArray(GA,A);
+  if(procRank != 0) return;
+  ulong h = 0;
+  for(long i=0;i<GA.n;i++) h = h*31+(ulong) f(A[i]);
+  cout << "digest = " << h << endl;
+}
+
+//cond function that always returns true
+inline bool cond_true (intT d) { return 1; }
+
+template<class vertex>
+void Compute(graph<vertex>&, commandLine);
+
+template<class vertex>
+void run(graph<vertex>& G, commandLine P, long rounds) {
+  localLo = G.part.lo(procRank); localHi = G.part.hi(procRank);
+  Compute(G,P);
+  G.mirrored->clear();
+  if(G.transposed) G.transpose();
+  for(int r=0;r<rounds;r++) {
+    barrier();
+    startTime();
+    Compute(G,P);
+    barrier();
+    if(procRank == 0) nextTime("Running time");
+    G.mirrored->clear();
+    if(G.transposed) G.transpose();
+  }
+  G.del();
+}
+
+int parallel_main(int argc, char* argv[]) {
+  initProcesses(&argc,&argv);
+  commandLine P(argc,argv," [-s] [-b] <inFile>");
+  char* iFile = P.getArgument(0);
+  bool symmetric = P.getOptionValue("-s");
+  bool binary = P.getOptionValue("-b");
+  long rounds = P.getOptionLongValue("-rounds",3);
+  if(symmetric) {
+    graph<symmetricVertex> G =
+      readGraph<symmetricVertex>(iFile,symmetric,binary); //symmetric graph
+    run(G,P,rounds);
+  } else {
+    graph<asymmetricVertex> G =
+      readGraph<asymmetricVertex>(iFile,symmetric,binary); //asymmetric graph
+    run(G,P,rounds);
+  }
+  finishProcesses();
+}
+#endif
@@ -25,8 +25,10 @@
 #include <iostream>
 #include <fstream>
 #include <stdlib.h>
+#include <string.h>
 #include "parallel.h"
 #include "quickSort.h"
+#include "blockRadixSort.h"
 using namespace std;
 
 typedef pair<uintE,uintE> intPair;
@@ -357,8 +359,333 @@ graph<vertex> readGraphFromBinary(char* iFile, bool isSymmetric) {
 #endif
 }
 
+//Formats of edge list inputs. TEXT_EDGE_LIST is a text file with one
+//edge "u v" (or "u v w" if weighted; w is 1 if it is missing) per
+//line, separated by spaces, tabs or commas, as in SNAP and TSV dumps;
+//lines starting with '#' or '%' are skipped. A text file that starts
+//with a Matrix Market header is read as a coordinate matrix, whose
+//entry (i,j) is the edge (i-1,j-1). BINARY_EDGE_LIST is an array of
+//(u,v) pairs of uintEs, as in the .adj file of the binary format.
+enum edgeListFormat { NO_EDGE_LIST, TEXT_EDGE_LIST, BINARY_EDGE_LIST };
+
+//Cleanup of edge lists, or-ed together. COMPACT_IDS relabels the
+//vertices that have an edge (after the other cleanup) to 0..n-1,
+//keeping their order.
+enum edgeListCleanup { REMOVE_DUPLICATES = 1, REMOVE_SELF_LOOPS = 2, COMPACT_IDS = 4 };
+
+#ifndef WEIGHTED
+typedef intPair listEdge; //(source,target)
+inline uintE& listTarget(listEdge& e) { return e.second; }
+#else
+typedef intTriple listEdge; //(source,(target,weight))
+inline uintE& listTarget(listEdge& e) { return e.second.first; }
+#endif
+
+struct listSourceF { uintE operator() (listEdge e) { return e.first; } };
+struct listTargetF { uintE operator() (listEdge e) { return listTarget(e); } };
+struct notSelfLoopF { bool operator() (listEdge e) { return e.first != listTarget(e); } };
+struct listMaxIDF {
+  listEdge* E;
+  listMaxIDF(listEdge* _E) : E(_E) {}
+  long operator() (long i) { return max(E[i].first,listTarget(E[i])); }
+};
+
+inline char* skipBlanks(char* s) {
+  while(*s == ' ' || *s == '\t' || *s == '\r' || *s == ',') s++;
+  return s;
+}
+
+//start of the line after the one at position i of A[0..len)
+inline long nextLine(char* A, long i, long len) {
+  char* e = (char*) memchr(A+i,'\n',len-i);
+  return (e == NULL) ? len : e-A+1;
+}
+
+//whether the line at s has an edge, i.e. is not blank or a comment
+inline bool isEdgeLine(char* s) {
+  s = skipBlanks(s);
+  return *s != '\n' && *s != 0 && *s != '#' && *s != '%';
+}
+
+//reads the vertex ID at s and moves s past it
+inline long readID(char*& s) {
+  s = skipBlanks(s);
+  if(*s < '0' || *s > '9') { cout << "Bad input file" << endl; abort(); }
+  long r = 0;
+  while(*s >= '0' && *s <= '9') {
+    r = 10*r + (*s++ - '0');
+    if(r >= UINT_E_MAX) { cout << "Out of bounds: vertex ID too large" << endl; abort(); }
+  }
+  return r;
+}
+
+#ifdef WEIGHTED
+//reads the weight at s, if there is one, rounded to an integer
+inline intE readWeight(char* s) {
+  s = skipBlanks(s);
+  if(*s == '\n' || *s == 0 || *s == '#' || *s == '%') return 1;
+  double w = strtod(s,NULL);
+  return (intE) ((w < 0) ? w-0.5 : w+0.5);
+}
+#endif
+
+//Reads a text edge list into E and returns the number of edges. Sets
+//n to the number of vertices, and mirror to 1 if the file is a
+//symmetric Matrix Market file, which stores one triangle of the matrix
+//(-1 if skew-symmetric). The file is split into blocks of lines that
+//are parsed in parallel, once to count the edges and once to read them.
+long readTextEdgeList(char* fname, listEdge*& E, long& n, int& mirror) {
+  _seq<char> S = readStringFromFile(fname);
+  char* A = S.A;
+  long len = S.n;
+  A[len] = 0;
+  long start = 0; //first line with edges
+  bool matrixMarket = (len >= 14 && strncmp(A,"%%MatrixMarket",14) == 0);
+  mirror = 0;
+  if(matrixMarket) {
+    string header(A,nextLine(A,0,len));
+    if(header.find("coordinate") == string::npos) {
+      cout << "Only coordinate Matrix Market files are supported" << endl;
+      abort(); }
+    if(header.find("skew-symmetric") != string::npos) mirror = -1;
+    else if(header.find("symmetric") != string::npos ||
+	    header.find("hermitian") != string::npos) mirror = 1;
+    //the first line that is not a comment has the dimensions
+    while(start < len && !isEdgeLine(A+start)) start = nextLine(A,start,len);
+    if(start == len) { cout << "Bad input file" << endl; abort(); }
+    char* s = A+start;
+    long rows = readID(s), cols = readID(s);
+    n = max(rows,cols);
+    start = nextLine(A,start,len);
+  }
+
+  long numBlocks = 1+((len-start) >> 16);
+  long* starts = newA(long,numBlocks+1);
+  {parallel_for(long b=0;b<numBlocks;b++) {
+      long i = start+(b << 16);
+      starts[b] = (b == 0 || A[i-1] == '\n') ? i : nextLine(A,i,len);
+    }}
+  starts[numBlocks] = len;
+  long* counts = newA(long,numBlocks);
+  {parallel_for(long b=0;b<numBlocks;b++) {
+      long c = 0;
+      for(long i=starts[b];i<starts[b+1];i=nextLine(A,i,len)) if(isEdgeLine(A+i)) c++;
+      counts[b] = c;
+    }}
+  long m = sequence::plusScan(counts,counts,numBlocks);
+
+  E = newA(listEdge,m);
+  long base = matrixMarket ? 1 : 0;
+  {parallel_for(long b=0;b<numBlocks;b++) {
+      long k = counts[b];
+      for(long i=starts[b];i<starts[b+1];i=nextLine(A,i,len)) {
+	if(!isEdgeLine(A+i)) continue;
+	char* s = A+i;
+	long u = readID(s), v = readID(s);
+	if(u < base || v < base || (matrixMarket && (u > n || v > n))) {
+	  cout << "Out of bounds: edge (" << u << "," << v << ")" << endl;
+	  abort(); }
+#ifndef WEIGHTED
+	E[k++] = make_pair(u-base,v-base);
+#else
+	E[k++] = make_pair(u-base,make_pair(v-base,readWeight(s)));
+#endif
+      }
+    }}
+  free(starts); free(counts); S.del();
+  if(!matrixMarket)
+    n = (m == 0) ? 0 : 1+sequence::reduce<long>((long)0,m,maxF<long>(),listMaxIDF(E));
+  return m;
+}
+
+//Reads a binary edge list into E and returns the number of edges; sets
+//n to the number of vertices. Edges get unit weights, as in
+//readGraphFromBinary.
+long readBinaryEdgeList(char* fname, listEdge*& E, long& n) {
+  _seq<char> S = readStringFromFile(fname);
+  long m = S.n/(2*sizeof(uintE));
+  uintE* P = (uintE*) S.A;
+  E = newA(listEdge,m);
+  {parallel_for(long i=0;i<m;i++) {
+      if(P[2*i] == UINT_E_MAX || P[2*i+1] == UINT_E_MAX) {
+	cout << "Out of bounds: vertex ID too large" << endl;
+	abort(); }
+#ifndef WEIGHTED
+      E[i] = make_pair(P[2*i],P[2*i+1]);
+#else
+      E[i] = make_pair(P[2*i],make_pair(P[2*i+1],(intE)1));
+#endif
+    }}
+  S.del();
+  n = (m == 0) ? 0 : 1+sequence::reduce<long>((long)0,m,maxF<long>(),listMaxIDF(E));
+  return m;
+}
+
+//relabels the vertices that appear in an edge to 0..k-1, keeping their
+//order, and returns k
+long compactIDs(listEdge* E, long m, long n) {
+  uintE* ids = newA(uintE,n);
+  {parallel_for(long i=0;i<n;i++) ids[i] = 0;}
+  {parallel_for(long i=0;i<m;i++) ids[E[i].first] = ids[listTarget(E[i])] = 1;}
+  long k = sequence::plusScan(ids,ids,n);
+  {parallel_for(long i=0;i<m;i++) {
+      E[i].first = ids[E[i].first];
+      listTarget(E[i]) = ids[listTarget(E[i])];
+    }}
+  free(ids);
+  return k;
+}
+
+//adds the reverse of each edge that is not a self-loop, with its weight
+//negated if negate is true
+listEdge* mirrorEdges(listEdge* E, long& m, bool negate) {
+  listEdge* F = newA(listEdge,2*m);
+  long k = sequence::filter(E,F+m,m,notSelfLoopF());
+  {parallel_for(long i=0;i<m;i++) F[i] = E[i];}
+  {parallel_for(long i=m;i<m+k;i++) {
+      uintE u = F[i].first;
+      F[i].first = listTarget(F[i]);
+      listTarget(F[i]) = u;
+#ifdef WEIGHTED
+      if(negate) F[i].second.second = -F[i].second.second;
+#endif
+    }}
+  free(E);
+  m += k;
+  return F;
+}
+
+//Sorts the edges by source and target with two passes of the stable
+//radix sort, so the edges with the same source and target stay in
+//input order, and removes the duplicates (keeping the first) and the
+//self-loops if asked to by cleanup.
+listEdge* sortEdgeList(listEdge* E, long& m, long n, int cleanup) {
+  if(m == 0) return E;
+  intSort::iSort(E,(uintT*)NULL,m,n,listTargetF());
+  intSort::iSort(E,(uintT*)NULL,m,n,listSourceF());
+  if(!(cleanup & (REMOVE_DUPLICATES | REMOVE_SELF_LOOPS))) return E;
+  bool* keep = newA(bool,m);
+  {parallel_for(long i=0;i<m;i++) {
+      uintE u = E[i].first, v = listTarget(E[i]);
+      keep[i] = !((cleanup & REMOVE_SELF_LOOPS) && u == v) &&
+	!((cleanup & REMOVE_DUPLICATES) && i > 0 &&
+	  E[i-1].first == u && listTarget(E[i-1]) == v);
+    }}
+  listEdge* F = newA(listEdge,m);
+  m = sequence::pack(E,F,keep,m);
+  free(E); free(keep);
+  return F;
+}
+
+//offsets of the vertices in a list of edges sorted by source; vertices
+//with no edges get the closest offset to the right
+uintT* listOffsets(listEdge* E, long m, long n) {
+  uintT* offsets = newA(uintT,n);
+  {parallel_for(long i=0;i<n;i++) offsets[i] = INT_T_MAX;}
+  {parallel_for(long i=0;i<m;i++)
+      if(i == 0 || E[i].first != E[i-1].first) offsets[E[i].first] = i;}
+  sequence::scanIBack(offsets,offsets,n,minF<uintT>(),(uintT)m);
+  return offsets;
+}
+
+//targets (and weights) of a list of edges, in the layout of graph.h
+#ifndef WEIGHTED
+uintE* listNeighbors(listEdge* E, long m) {
+  uintE* edges = newA(uintE,m);
+  {parallel_for(long i=0;i<m;i++) edges[i] = E[i].second;}
+  return edges;
+}
+#else
+intE* listNeighbors(listEdge* E, long m) {
+  intE* edges = newA(intE,2*m);
+  {parallel_for(long i=0;i<m;i++) {
+      edges[2*i] = E[i].second.first;
+      edges[2*i+1] = E[i].second.second;
+    }}
+  return edges;
+}
+#endif
+
+//builds the graph from a list of edges sorted by source and target,
+//and frees the list
+template <class vertex>
+graph<vertex> graphFromEdgeList(listEdge* E, long m, long n, bool isSymmetric) {
+  uintT* offsets = listOffsets(E,m,n);
+#ifndef WEIGHTED
+  uintE* edges = listNeighbors(E,m);
+#else
+  intE* edges = listNeighbors(E,m);
+#endif
+  vertex* v = newA(vertex,n);
+  {parallel_for(long i=0;i<n;i++) {
+      uintT o = offsets[i];
+      uintT l = ((i == n-1) ? m : offsets[i+1])-offsets[i];
+      v[i].setOutDegree(l);
+#ifndef WEIGHTED
+      v[i].setOutNeighbors(edges+o);
+#else
+      v[i].setOutNeighbors(edges+2*o);
+#endif
+    }}
+  free(offsets);
+  if(isSymmetric) {
+    free(E);
+    return graph<vertex>(v,n,m,edges);
+  }
+
+  //the in-edges are the reversed edges, which are already sorted by
+  //their new target, so one pass by their new source sorts them
+  {parallel_for(long i=0;i<m;i++) {
+      uintE u = E[i].first;
+      E[i].first = listTarget(E[i]);
+      listTarget(E[i]) = u;
+    }}
+  if(m > 0) intSort::iSort(E,(uintT*)NULL,m,n,listSourceF());
+  uintT* tOffsets = listOffsets(E,m,n);
+#ifndef WEIGHTED
+  uintE* inEdges = listNeighbors(E,m);
+#else
+  intE* inEdges = listNeighbors(E,m);
+#endif
+  free(E);
+  {parallel_for(long i=0;i<n;i++) {
+      uintT o = tOffsets[i];
+      uintT l = ((i == n-1) ? m : tOffsets[i+1])-tOffsets[i];
+      v[i].setInDegree(l);
+#ifndef WEIGHTED
+      v[i].setInNeighbors(inEdges+o);
+#else
+      v[i].setInNeighbors(inEdges+2*o);
+#endif
+    }}
+  free(tOffsets);
+  return graph<vertex>(v,n,m,edges,inEdges);
+}
+
+//Reads an edge list (see edgeListFormat) directly into a graph. For a
+//symmetric graph every edge is added in both directions, and the
+//duplicates and self-loops are removed, as by SNAPtoAdj -s.
+template <class vertex>
+graph<vertex> readGraphFromEdgeList(char* fname, bool isSymmetric, edgeListFormat format, int cleanup) {
+  listEdge* E;
+  long n;
+  int mirror = 0;
+  long m = (format == BINARY_EDGE_LIST) ? readBinaryEdgeList(fname,E,n) :
+    readTextEdgeList(fname,E,n,mirror);
+  if(isSymmetric) cleanup |= REMOVE_DUPLICATES | REMOVE_SELF_LOOPS;
+  if(isSymmetric || mirror != 0) E = mirrorEdges(E,m,mirror == -1);
+  E = sortEdgeList(E,m,n,cleanup);
+  //after the cleanup, so vertices left with no edges are removed; the
+  //order of the IDs is kept, so the edges stay sorted
+  if(cleanup & COMPACT_IDS) n = compactIDs(E,m,n);
+  return graphFromEdgeList<vertex>(E,m,n,isSymmetric);
+}
+
 template <class vertex>
-graph<vertex> readGraph(char* iFile, bool symmetric, bool binary) {
+graph<vertex> readGraph(char* iFile, bool symmetric, bool binary,
+			edgeListFormat edgeList = NO_EDGE_LIST, int cleanup = 0) {
+  if(edgeList != NO_EDGE_LIST)
+    return readGraphFromEdgeList<vertex>(iFile,symmetric,edgeList,cleanup);
   if(binary) return readGraphFromBinary<vertex>(iFile,symmetric); 
   else return readGraphFromFile<vertex>(iFile,symmetric);
 }
@@ -0,0 +1,285 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Batch-dynamic graph. Wraps a graph<vertex> read by readGraph and
+// applies batches of edge insertions and deletions to it in parallel.
+// Every neighbor list stays a sorted contiguous array, so G can be
+// passed to edgeMap/vertexMap as before and scans run at CSR speed.
+// A list is updated in place while it fits in its block, and is
+// otherwise moved to a new block with twice the needed space. compact()
+// copies all lists back into one array; the old storage is kept until
+// the next compact() or reclaim(), so readers of the previous G are
+// not blocked. Batches should not be applied while G is being read.
+#ifndef DYNAMIC_GRAPH_H
+#define DYNAMIC_GRAPH_H
+#include <vector>
+#include "parallel.h"
+#include "utils.h"
+#include "graph.h"
+#include "quickSort.h"
+using namespace std;
+
+#ifndef WEIGHTED
+typedef uintE dynEdge;
+typedef uintE dynNghT;
+inline uintE dynNgh(const dynEdge& e) { return e; }
+inline dynEdge dynMakeEdge(uintE ngh, const dynEdge& e) { return ngh; }
+#else
+typedef pair<intE,intE> dynEdge; //neighbor and weight, as stored by graph.h
+typedef intE dynNghT;
+inline uintE dynNgh(const dynEdge& e) { return e.first; }
+inline dynEdge dynMakeEdge(uintE ngh, const dynEdge& e) { return make_pair((intE)ngh,e.second); }
+#endif
+
+inline bool dynIsSymmetric(symmetricVertex*) { return 1; }
+inline bool dynIsSymmetric(asymmetricVertex*) { return 0; }
+
+//an update to the list of vertex first
+typedef pair<uintE,dynEdge> dynUpdate;
+
+struct dynEdgeLess {
+  bool operator() (const dynEdge& a, const dynEdge& b) {
+    return dynNgh(a) < dynNgh(b); }};
+
+struct dynUpdateLess {
+  bool operator() (const dynUpdate& a, const dynUpdate& b) {
+    if(a.first != b.first) return a.first < b.first;
+    return dynNgh(a.second) < dynNgh(b.second); }};
+
+template <class vertex>
+struct dynamicGraph {
+  graph<vertex> G;
+  bool symmetric;
+  //per-vertex block holding the list if it was moved out of the base
+  //array (NULL otherwise), and the capacity of the list's storage
+  dynEdge** outBlock, **inBlock;
+  uintT* outCap, *inCap;
+  dynEdge* outBase, *inBase;
+  vector<void*> retired; //storage of views replaced by compact()
+
+  dynamicGraph(graph<vertex> _G) : G(_G) {
+    long n = G.n;
+    symmetric = dynIsSymmetric(G.V);
+    outBase = (dynEdge*) G.allocatedInplace;
+    inBase = symmetric ? NULL : (dynEdge*) G.inEdges;
+    outBlock = newA(dynEdge*,n); outCap = newA(uintT,n);
+    inBlock = symmetric ? NULL : newA(dynEdge*,n);
+    inCap = symmetric ? NULL : newA(uintT,n);
+    {parallel_for(long i=0;i<n;i++) {
+      outBlock[i] = NULL;
+      outCap[i] = G.V[i].getOutDegree();
+      quickSort(getList(i,0),outCap[i],dynEdgeLess());
+      if(!symmetric) {
+	inBlock[i] = NULL;
+	inCap[i] = G.V[i].getInDegree();
+	quickSort(getList(i,1),inCap[i],dynEdgeLess());
+      }
+      }}
+  }
+
+  dynEdge* getList(uintE v, bool in) {
+    return (dynEdge*) (in ? G.V[v].getInNeighbors() : G.V[v].getOutNeighbors());
+  }
+  uintT getDegree(uintE v, bool in) {
+    return in ? G.V[v].getInDegree() : G.V[v].getOutDegree();
+  }
+  void setList(uintE v, bool in, dynEdge* A, uintT d) {
+    if(in) { G.V[v].setInNeighbors((dynNghT*) A); G.V[v].setInDegree(d); }
+    else { G.V[v].setOutNeighbors((dynNghT*) A); G.V[v].setOutDegree(d); }
+  }
+
+  //merges the sorted updates U[0..b) into the list of v; edges already
+  //present keep their position (and take the new weight). Returns the
+  //number of edges added.
+  long insertList(uintE v, bool in, dynUpdate* U, long b) {
+    dynEdge* A = getList(v,in);
+    long d = getDegree(v,in), added = 0;
+    for(long i=0,j=0;j<b;) {
+      if(i < d && dynNgh(A[i]) < dynNgh(U[j].second)) i++;
+      else { if(i >= d || dynNgh(A[i]) != dynNgh(U[j].second)) added++; j++; }
+    }
+    long nd = d+added;
+    dynEdge*& block = in ? inBlock[v] : outBlock[v];
+    uintT& cap = in ? inCap[v] : outCap[v];
+    if(nd <= cap) { //merge backwards in place
+      long i = d-1, j = b-1, w = nd-1;
+      while(j >= 0) {
+	if(i >= 0 && dynNgh(A[i]) > dynNgh(U[j].second)) A[w--] = A[i--];
+	else if(i >= 0 && dynNgh(A[i]) == dynNgh(U[j].second)) { A[w--] = U[j--].second; i--; }
+	else A[w--] = U[j--].second;
+      }
+    } else { //move to a new block with slack
+      long newCap = max((long)4,2*nd);
+      dynEdge* B = newA(dynEdge,newCap);
+      long i = 0, j = 0, w = 0;
+      while(i < d || j < b) {
+	if(j >= b || (i < d && dynNgh(A[i]) < dynNgh(U[j].second))) B[w++] = A[i++];
+	else if(i < d && dynNgh(A[i]) == dynNgh(U[j].second)) { B[w++] = U[j++].second; i++; }
+	else B[w++] = U[j++].second;
+      }
+      if(block != NULL) free(block);
+      block = A = B;
+      cap = newCap;
+    }
+    setList(v,in,A,nd);
+    return added;
+  }
+
+  //removes the neighbors in the sorted updates U[0..b) from the list of
+  //v, in place. Returns the number of edges removed.
+  long deleteList(uintE v, bool in, dynUpdate* U, long b) {
+    dynEdge* A = getList(v,in);
+    long d = getDegree(v,in), w = 0;
+    for(long i=0,j=0;i<d;i++) {
+      while(j < b && dynNgh(U[j].second) < dynNgh(A[i])) j++;
+      if(j < b && dynNgh(U[j].second) == dynNgh(A[i])) continue;
+      A[w++] = A[i];
+    }
+    setList(v,in,A,w);
+    return d-w;
+  }
+
+  //sorts and deduplicates U, then applies each vertex's group of
+  //updates in parallel. Frees U. Returns the change in edge count.
+  long applyBatch(dynUpdate* U, long k, bool in, bool insert) {
+    if(k == 0) { free(U); return 0; }
+    quickSort(U,k,dynUpdateLess());
+    bool* fl = newA(bool,k);
+    fl[0] = 1;
+    {parallel_for(long i=1;i<k;i++)
+	fl[i] = (U[i].first != U[i-1].first || dynNgh(U[i].second) != dynNgh(U[i-1].second));}
+    dynUpdate* V = newA(dynUpdate,k);
+    k = sequence::pack(U,V,fl,k);
+    free(U); U = V;
+    {parallel_for(long i=1;i<k;i++) fl[i] = (U[i].first != U[i-1].first);}
+    _seq<long> starts = sequence::packIndex<long>(fl,k);
+    long numGroups = starts.n;
+    long* changed = newA(long,numGroups);
+    {parallel_for(long g=0;g<numGroups;g++) {
+      long s = starts.A[g], e = (g == numGroups-1) ? k : starts.A[g+1];
+      changed[g] = insert ? insertList(U[s].first,in,U+s,e-s) :
+	deleteList(U[s].first,in,U+s,e-s);
+      }}
+    long total = sequence::plusReduce(changed,numGroups);
+    free(changed); starts.del(); free(fl); free(U);
+    return total;
+  }
+
+  //builds the per-direction update arrays for a batch of k edges E[i]
+  //from E[i].first to dynNgh(E[i].second) and applies them
+  long update(dynUpdate* E, long k, bool insert) {
+    if(G.tiles != NULL) { //built for the old edges
+      G.tiles->del(); free(G.tiles); G.tiles = NULL; }
+    dynUpdate* out = newA(dynUpdate,symmetric ? 2*k : k);
+    {parallel_for(long i=0;i<k;i++) out[i] = E[i];}
+    if(symmetric) {
+      {parallel_for(long i=0;i<k;i++)
+	  out[k+i] = make_pair(dynNgh(E[i].second),dynMakeEdge(E[i].first,E[i].second));}
+      long delta = applyBatch(out,2*k,0,insert);
+      G.m += insert ? delta : -delta;
+      return delta/2;
+    }
+    dynUpdate* in = newA(dynUpdate,k);
+    {parallel_for(long i=0;i<k;i++)
+	in[i] = make_pair(dynNgh(E[i].second),dynMakeEdge(E[i].first,E[i].second));}
+    long delta = applyBatch(out,k,0,insert);
+    applyBatch(in,k,1,insert);
+    G.m += insert ? delta : -delta;
+    return delta;
+  }
+
+  //Inserts a batch of edges; edges already present are ignored (for
+  //weighted graphs their weight is updated). For symmetric graphs both
+  //directions are inserted. Returns the number of edges added.
+  long insertEdges(dynUpdate* E, long k) { return update(E,k,1); }
+
+  //Deletes a batch of edges; edges not present are ignored. Returns the
+  //number of edges removed.
+  long deleteEdges(dynUpdate* E, long k) { return update(E,k,0); }
+
+  //copies the lists of one direction into a single new array
+  dynEdge* compactLists(vertex* newV, bool in) {
+    long n = G.n;
+    uintT* offsets = newA(uintT,n);
+    {parallel_for(long i=0;i<n;i++) offsets[i] = getDegree(i,in);}
+    long total = sequence::plusScan(offsets,offsets,n);
+    dynEdge* base = newA(dynEdge,total);
+    {parallel_for(long i=0;i<n;i++) {
+      dynEdge* A = getList(i,in);
+      long d = getDegree(i,in);
+      for(long j=0;j<d;j++) base[offsets[i]+j] = A[j];
+      if(in) { newV[i].setInNeighbors((dynNghT*) (base+offsets[i])); inCap[i] = d; }
+      else { newV[i].setOutNeighbors((dynNghT*) (base+offsets[i])); outCap[i] = d; }
+      }}
+    free(offsets);
+    return base;
+  }
+
+  //frees the storage retired by the last compact()
+  void reclaim() {
+    for(long i=0;i<retired.size();i++) free(retired[i]);
+    retired.clear();
+  }
+
+  //Copies all lists into fresh contiguous arrays and switches G to
+  //them. The previous view stays valid until the next compact() or
+  //reclaim().
+  void compact() {
+    long n = G.n;
+    reclaim();
+    vertex* newV = newA(vertex,n);
+    {parallel_for(long i=0;i<n;i++) newV[i] = G.V[i];}
+    dynEdge* newOut = compactLists(newV,0);
+    dynEdge* newIn = symmetric ? NULL : compactLists(newV,1);
+    retired.push_back(G.V);
+    retired.push_back(outBase);
+    if(!symmetric) retired.push_back(inBase);
+    for(long i=0;i<n;i++) {
+      if(outBlock[i] != NULL) { retired.push_back(outBlock[i]); outBlock[i] = NULL; }
+      if(!symmetric && inBlock[i] != NULL) { retired.push_back(inBlock[i]); inBlock[i] = NULL; }
+    }
+    outBase = newOut; inBase = newIn;
+    G.allocatedInplace = (dynNghT*) outBase;
+    G.inEdges = (dynNghT*) inBase;
+    G.V = newV;
+  }
+
+  void del() {
+    reclaim();
+    long n = G.n;
+    for(long i=0;i<n;i++) {
+      if(outBlock[i] != NULL) free(outBlock[i]);
+      if(!symmetric && inBlock[i] != NULL) free(inBlock[i]);
+    }
+    free(outBlock); free(outCap);
+    if(!symmetric) { free(inBlock); free(inCap); }
+    if(outBase != NULL) free(outBase);
+    if(inBase != NULL) free(inBase);
+    if(G.flags != NULL) free(G.flags);
+    if(G.tiles != NULL) { G.tiles->del(); free(G.tiles); }
+    free(G.V);
+  }
+};
+
+#endif
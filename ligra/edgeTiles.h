@@ -0,0 +1,129 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Edge-centric dense edgeMap. The edges are stored once as a grid of
+// tiles (see edgeTiles in graph.h): tile (i,j) holds the edges from
+// source range i to destination range j, in order of source. A dense
+// round gives each destination range to one worker, which streams its
+// tiles from the sources that have a vertex in the frontier; the state
+// of both the sources and the destinations of a tile is within a range
+// of 2^logB vertices, so it stays in cache, and since no other worker
+// writes to the destinations update is used instead of updateAtomic.
+// Included from ligra.h.
+#ifndef EDGE_TILES_H
+#define EDGE_TILES_H
+#include "parallel.h"
+#include "utils.h"
+#include "graph.h"
+
+//default width of a range: at most 2^16, and narrower (down to 2^8)
+//while there are fewer than 8 ranges per worker, since a dense round
+//has one task per range; wider for big graphs, so that there are at
+//most 2^10 ranges and the tile offsets stay small
+inline long defaultTileBits(long n) {
+  long logB = 16, minParts = 8*getWorkers();
+  while(logB > 8 && ((n-1) >> logB)+1 < minParts) logB--;
+  while((n >> logB) >= (1L << 10)) logB++;
+  return logB;
+}
+
+//Builds the tiles of a graph with n vertices, where vertex v has
+//Degrees[v] out-edges. listF(v,D,W) writes the targets of the edges of
+//v to D and, if W is not NULL, their weights to W.
+template <class LF>
+edgeTiles* makeEdgeTiles(long n, uintT* Degrees, LF listF, bool weighted, long logB) {
+  edgeTiles* T = newA(edgeTiles,1);
+  long B = 1L << logB, P = (n+B-1) >> logB;
+  T->n = n; T->logB = logB; T->numParts = P;
+
+  //all out-edges, in order of source
+  long* offsets = newA(long,n+1);
+  {parallel_for(long i=0;i<n;i++) offsets[i] = Degrees[i];}
+  offsets[n] = 0;
+  long m = sequence::plusScan(offsets,offsets,n+1);
+  uintE* D = newA(uintE,m);
+  intE* W = weighted ? newA(intE,m) : NULL;
+  {parallel_for(long v=0;v<n;v++) listF(v,D+offsets[v],weighted ? W+offsets[v] : NULL);}
+
+  //number of edges of each tile, in order of destination range
+  long* counts = newA(long,P*P+1);
+  {parallel_for(long i=0;i<P*P+1;i++) counts[i] = 0;}
+  {parallel_for_1(long i=0;i<P;i++) {
+      long first = offsets[i*B], last = offsets[min(n,(i+1)*B)];
+      for(long e=first;e<last;e++) counts[(D[e] >> logB)*P+i]++;
+    }}
+  sequence::plusScan(counts,counts,P*P+1);
+
+  //each source range writes its edges to its tiles, keeping their order
+  T->src = newA(uintE,m);
+  T->dst = newA(uintE,m);
+  T->weights = weighted ? newA(intE,m) : NULL;
+  {parallel_for_1(long i=0;i<P;i++) {
+      long* pos = newA(long,P);
+      for(long j=0;j<P;j++) pos[j] = counts[j*P+i];
+      for(long v=i*B;v<min(n,(i+1)*B);v++)
+	for(long e=offsets[v];e<offsets[v+1];e++) {
+	  long k = pos[D[e] >> logB]++;
+	  T->src[k] = v; T->dst[k] = D[e];
+	  if(weighted) T->weights[k] = W[e];
+	}
+      free(pos);
+    }}
+  T->offsets = counts;
+  free(offsets); free(D);
+  if(W != NULL) free(W);
+  return T;
+}
+
+//Dense edgeMap over the tiles: applies f to the edges from frontier
+//vertices, and returns the vertices for which update returned true
+template <class F>
+bool* edgeMapTiles(edgeTiles* T, bool* frontier, F f) {
+  long n = T->n, logB = T->logB, P = T->numParts, B = 1L << logB;
+  bool* next = newA(bool,n);
+  //source ranges with no vertex in the frontier are skipped
+  bool* active = newA(bool,P);
+  {parallel_for(long i=0;i<P;i++) {
+      active[i] = 0;
+      for(long v=i*B;v<min(n,(i+1)*B);v++) if(frontier[v]) { active[i] = 1; break; }
+    }}
+  {parallel_for_1(long j=0;j<P;j++) {
+      for(long v=j*B;v<min(n,(j+1)*B);v++) next[v] = 0;
+      for(long i=0;i<P;i++) {
+	if(!active[i]) continue;
+	for(long e=T->offsets[j*P+i];e<T->offsets[j*P+i+1];e++) {
+	  uintE s = T->src[e], d = T->dst[e];
+#ifndef WEIGHTED
+	  if(frontier[s] && f.cond(d) && f.update(s,d)) next[d] = 1;
+#else
+	  if(frontier[s] && f.cond(d) && f.update(s,d,T->weights[e])) next[d] = 1;
+#endif
+	}
+      }
+    }}
+  free(active);
+  return next;
+}
+
+#endif
@@ -90,6 +90,20 @@ asymmetricVertex(intE* iN, intE* oN, uintT id, uintT od)
   void flipEdges() { swap(inNeighbors,outNeighbors); swap(inDegree,outDegree); }
 };
 
+//Edges grouped into tiles by destination and source range (see
+//edgeTiles.h), built by buildEdgeTiles for the EDGE_STREAM option of
+//edgeMap. Vertices are split into numParts ranges of 2^logB; the edges
+//from range i to range j are src/dst[offsets[j*numParts+i]..
+//offsets[j*numParts+i+1]-1], in order of source.
+struct edgeTiles {
+  long n, logB, numParts;
+  long* offsets;
+  uintE* src, *dst;
+  intE* weights; //NULL if unweighted
+  bool transposed; //direction of the graph when the tiles were built
+  void del() { free(offsets); free(src); free(dst); if(weights != NULL) free(weights); }
+};
+
 template <class vertex>
 struct graph {
   vertex *V;
@@ -102,16 +116,18 @@ struct graph {
 #endif
   uintE* flags;
   bool transposed;
+  edgeTiles* tiles; //NULL unless built by buildEdgeTiles
   graph(vertex* VV, long nn, long mm) 
-  : V(VV), n(nn), m(mm), allocatedInplace(NULL), flags(NULL), transposed(false) {}
+  : V(VV), n(nn), m(mm), allocatedInplace(NULL), flags(NULL), transposed(false), tiles(NULL) {}
 #ifndef WEIGHTED
   graph(vertex* VV, long nn, long mm, uintE* ai, uintE* _inEdges = NULL) 
 #else
   graph(vertex* VV, long nn, long mm, intE* ai, intE* _inEdges = NULL) 
 #endif
-  : V(VV), n(nn), m(mm), allocatedInplace(ai), inEdges(_inEdges), flags(NULL), transposed(false) {}
+  : V(VV), n(nn), m(mm), allocatedInplace(ai), inEdges(_inEdges), flags(NULL), transposed(false), tiles(NULL) {}
   void del() {
     if (flags != NULL) free(flags);
+    if (tiles != NULL) { tiles->del(); free(tiles); }
     if (allocatedInplace == NULL) 
       for (long i=0; i < n; i++) V[i].del();
     else free(allocatedInplace);
@@ -127,4 +143,27 @@ struct graph {
     } 
   }
 };
+
+//The same interface as for compressed graphs in Ligra+ (see
+//skipIndex.h there), so that apps can be written for both.
+
+//j-th out-neighbor of v
+template <class vertex>
+inline uintE getOutNeighbor(graph<vertex>& G, uintE v, uintT j) {
+  return G.V[v].getOutNeighbor(j);
+}
+
+//j-th in-neighbor of v
+template <class vertex>
+inline uintE getInNeighbor(graph<vertex>& G, uintE v, uintT j) {
+  return G.V[v].getInNeighbor(j);
+}
+
+//whether (u,v) is an edge; the list of u need not be sorted
+template <class vertex>
+inline bool hasEdge(graph<vertex>& G, uintE u, uintE v) {
+  uintT d = G.V[u].getOutDegree();
+  for(uintT j=0;j<d;j++) if(G.V[u].getOutNeighbor(j) == v) return 1;
+  return 0;
+}
 #endif
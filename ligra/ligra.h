@@ -28,6 +28,7 @@
 #include <stdlib.h>
 #include <cstring>
 #include <string>
+#include <sstream>
 #include <algorithm>
 #include "parallel.h"
 #include "gettime.h"
@@ -35,6 +36,12 @@
 #include "graph.h"
 #include "IO.h"
 #include "parseCommandLine.h"
+#include "queryServer.h"
+#include "sparseMap.h"
+#include "worklist.h"
+#include "multiQueue.h"
+#include "edgeTiles.h"
+#include "dynamicGraph.h"
 #include "gettime.h"
 using namespace std;
 
@@ -126,14 +133,15 @@ vertexSubset(long _n, long _m, bool* bits)
 
 struct nonMaxF{bool operator() (uintE &a) {return (a != UINT_E_MAX);}};
 
-//options to edgeMap for different versions of dense edgeMap (default is DENSE)
-enum options { DENSE, DENSE_FORWARD};
+//options to edgeMap for different versions of dense edgeMap (default
+//is DENSE); EDGE_STREAM uses the tiles of the graph (see edgeTiles.h)
+//if they were built, and DENSE otherwise
+enum options { DENSE, DENSE_FORWARD, EDGE_STREAM};
 
-//remove duplicate integers in [0,...,n-1]
+//remove duplicate integers in [0,...,n-1]; without flags, a hash
+//table of size O(m) is used instead
 void remDuplicates(uintE* indices, uintE* flags, long m, long n) {
-  //make flags for first time
-  if(flags == NULL) {flags = newA(uintE,n); 
-    {parallel_for(long i=0;i<n;i++) flags[i]=UINT_E_MAX;}}
+  if(flags == NULL) { remDuplicatesSparse(indices,m); return; }
   {parallel_for(uintE i=0;i<m;i++)
       if(indices[i] != UINT_E_MAX && flags[indices[i]] == UINT_E_MAX) 
 	CAS(&flags[indices[i]],(uintE)UINT_E_MAX,i);
@@ -297,9 +305,12 @@ vertexSubset edgeMap(graph<vertex> GA, vertexSubset &V, F f, intT threshold = -1
     V.toDense();
     free(degrees);
     free(frontierVertices);
-    bool* R = (option == DENSE_FORWARD) ? 
+    bool* R = (option == EDGE_STREAM && GA.tiles != NULL && 
+	       GA.tiles->transposed == GA.transposed) ?
+      edgeMapTiles(GA.tiles,V.d,f) :
+      (option == DENSE_FORWARD) ? 
       edgeMapDenseForward(GA,V.d,f) : 
-      edgeMapDense(GA, V.d, f, option);
+      edgeMapDense(GA, V.d, f);
     vertexSubset v1 = vertexSubset(numVertices, R);
     //cout << "size (D) = " << v1.m << endl;
     return  v1;
@@ -316,6 +327,111 @@ vertexSubset edgeMap(graph<vertex> GA, vertexSubset &V, F f, intT threshold = -1
   }
 }
 
+//Asynchronous edgeMap: processes the out-edges of the vertices of V and
+//of every vertex for which updateAtomic returns true, in the same call,
+//until no vertex is left. Vertices are taken from the scheduler W by
+//the next free worker, so updates propagate without waiting for a
+//round to end; W is a vertexWorklist (FIFO, see worklist.h) for
+//edgeMapAsync, or a multiQueue (by priority, see multiQueue.h).
+//updateAtomic must return true whenever it changed the value of d (not
+//only the first time in a round), since a vertex can be processed more
+//than once. The edges of a vertex are processed by one worker.
+//Returns the number of vertices added to W, or -1 if it became larger
+//than maxVisits (if not -1), in which case the values are not final.
+template <class F, class vertex, class S>
+long edgeMapScheduled(graph<vertex> GA, vertexSubset &V, F f, S &W, long maxVisits = -1) {
+  long n = GA.n;
+  vertex *G = GA.V;
+  if (n != V.numRows()) {
+    cout << "edgeMapScheduled: Sizes Don't match" << endl;
+    abort();
+  }
+  V.toSparse();
+  {parallel_for(long i=0;i<V.numNonzeros();i++) W.activate(V.s[i]);}
+  volatile bool stop = 0;
+  long P = getWorkers();
+  {parallel_for_1(long w=0;w<P;w++) {
+      uintE v;
+      while(!stop) {
+	if(W.next(v)) {
+	  vertex vert = G[v];
+	  uintE d = vert.getOutDegree();
+	  for(uintE j=0;j<d;j++) {
+	    uintE ngh = vert.getOutNeighbor(j);
+#ifndef WEIGHTED
+	    if(f.cond(ngh) && f.updateAtomic(v,ngh))
+#else
+	    if(f.cond(ngh) && f.updateAtomic(v,ngh,vert.getOutWeight(j)))
+#endif
+	      W.activate(ngh);
+	  }
+	  W.finish();
+	  if(maxVisits != -1 && W.added() > maxVisits) stop = 1;
+	} else if(W.done()) break;
+	else W.wait();
+      }
+    }}
+  return stop ? -1 : W.added();
+}
+
+//edgeMapScheduled with a FIFO queue, in which each vertex is at most
+//once at a time
+template <class F, class vertex>
+long edgeMapAsync(graph<vertex> GA, vertexSubset &V, F f, long maxVisits = -1) {
+  vertexWorklist W(GA.n);
+  long visits = edgeMapScheduled(GA,V,f,W,maxVisits);
+  W.del();
+  return visits;
+}
+
+//writes the out-edges of v for makeEdgeTiles
+template <class vertex>
+struct outEdgeListF {
+  vertex* G;
+  outEdgeListF(vertex* _G) : G(_G) {}
+  inline void operator() (uintE v, uintE* D, intE* W) {
+    uintT d = G[v].getOutDegree();
+    for(uintT j=0;j<d;j++) {
+      D[j] = G[v].getOutNeighbor(j);
+#ifdef WEIGHTED
+      W[j] = G[v].getOutWeight(j);
+#endif
+    }
+  }
+};
+
+//Builds the tiles of GA for the EDGE_STREAM option of edgeMap, from
+//its out-edges; they are used while GA is not transposed from the
+//direction it has now. logB is the log of the width of a range (by
+//default, see defaultTileBits).
+template <class vertex>
+void buildEdgeTiles(graph<vertex>& GA, long logB = -1) {
+  if(GA.tiles != NULL) { GA.tiles->del(); free(GA.tiles); }
+  if(logB < 0) logB = defaultTileBits(GA.n);
+  vertex* G = GA.V;
+  uintT* degrees = newA(uintT,GA.n);
+  {parallel_for(long i=0;i<GA.n;i++) degrees[i] = G[i].getOutDegree();}
+#ifndef WEIGHTED
+  GA.tiles = makeEdgeTiles(GA.n,degrees,outEdgeListF<vertex>(G),false,logB);
+#else
+  GA.tiles = makeEdgeTiles(GA.n,degrees,outEdgeListF<vertex>(G),true,logB);
+#endif
+  GA.tiles->transposed = GA.transposed;
+  free(degrees);
+}
+
+//Returns the sum of A[u] over the in-neighbors u of v, for kernels
+//that gather over all in-edges (such as PageRank) and need no edgeMap
+//functor.
+template <class vertex, class T>
+inline T inNeighborSum(graph<vertex>& GA, uintE v, T* A) {
+  vertex& V = GA.V[v];
+  uintT d = V.getInDegree();
+  T sum = 0;
+  for(uintT j=0;j<d;j++) sum += A[V.getInNeighbor(j)];
+  return sum;
+}
+
 //*****VERTEX FUNCTIONS*****
 
 //Note: this is the optimized version of vertexMap which does not
@@ -345,21 +461,118 @@ vertexSubset vertexFilter(vertexSubset V, F filter) {
   return vertexSubset(n,d_out);
 }
 
+//vertexFilter for a sparse V that only visits the vertices of V and
+//returns a sparse vertexSubset, so its cost is proportional to |V|
+//instead of n; a dense V is filtered with vertexFilter
+template <class F>
+vertexSubset vertexFilterSparse(vertexSubset& V, F filter) {
+  long n = V.numRows(), m = V.numNonzeros();
+  if(V.isDense) return vertexFilter(V,filter);
+  if(m == 0) return vertexSubset(n);
+  bool* keep = newA(bool,m);
+  {parallel_for(long i=0;i<m;i++) keep[i] = filter(V.s[i]);}
+  _seq<uintE> out = sequence::pack((uintE*) NULL,keep,(long) 0,m,sequence::getA<uintE,long>(V.s));
+  free(keep);
+  return vertexSubset(n,out.n,out.A);
+}
+
+//Declares that edgeMap functors read A[s] at the sources s of edges.
+//The distributed version (in ligra-mpi) sends these values to the
+//processes that need them; here it does nothing.
+template <class vertex, class T>
+inline void mirrorArray(graph<vertex>& GA, T* A) {}
+
+//With "-digest", apps print a digest of their result after each run,
+//so that builds can be compared: reportDigest(GA,P,A,f) prints
+//"digest = h", where h combines f(A[v]) over all vertices in order
+//(by default f(x) = x).
+struct digestValueF {
+  template <class T>
+  inline long operator() (T x) { return (long) x; }};
+
+template <class vertex, class T, class F = digestValueF>
+void reportDigest(graph<vertex>& GA, commandLine& P, T* A, F f = F()) {
+  if(!P.getOption("-digest")) return;
+  ulong h = 0;
+  for(long i=0;i<GA.n;i++) h = h*31+(ulong) f(A[i]);
+  cout << "digest = " << h << endl;
+}
+
 //cond function that always returns true
 inline bool cond_true (intT d) { return 1; }
 
 template<class vertex>
 void Compute(graph<vertex>&, commandLine);
 
+//With "-updates <file>", the graph is wrapped in a dynamicGraph and
+//Compute is run once, and then again after each batch of updates in
+//the file. A line "+ u v [w]" inserts and "- u v" deletes the edge
+//(u,v) (w is the weight of an inserted edge, 1 by default), and a
+//line "=" ends a batch. The deletions of a batch are applied first.
+template <class vertex>
+void runUpdates(graph<vertex>& G, commandLine P, char* file) {
+  ifstream in(file);
+  if(!in.is_open()) { cout << "Unable to open file: " << file << endl; abort(); }
+  dynamicGraph<vertex> D(G);
+  Compute(D.G,P);
+  if(D.G.transposed) D.G.transpose();
+  vector<dynUpdate> ins, dels;
+  string line;
+  long batch = 0;
+  while(1) {
+    bool end = !getline(in,line);
+    if(!end && line != "=") {
+      istringstream ls(line);
+      char op; long u, v, w = 1;
+      if(!(ls >> op)) continue; //blank line
+      if((op != '+' && op != '-') || !(ls >> u >> v) ||
+	 u < 0 || v < 0 || u >= D.G.n || v >= D.G.n) {
+	cout << "updates: bad line \"" << line << "\"" << endl; abort(); }
+      ls >> w;
+#ifndef WEIGHTED
+      dynEdge e = v;
+#else
+      dynEdge e = make_pair((intE) v,(intE) w);
+#endif
+      (op == '+' ? ins : dels).push_back(make_pair((uintE) u,e));
+      continue;
+    }
+    if(!ins.empty() || !dels.empty()) {
+      startTime();
+      long removed = D.deleteEdges(dels.data(),dels.size());
+      long added = D.insertEdges(ins.data(),ins.size());
+      nextTime("Update time");
+      cout << "batch " << ++batch << ": " << added << " edges added, "
+	   << removed << " removed" << endl;
+      ins.clear(); dels.clear();
+      startTime();
+      Compute(D.G,P);
+      nextTime("Running time");
+      if(D.G.transposed) D.G.transpose();
+    }
+    if(end) break;
+  }
+  D.del();
+}
+
 int parallel_main(int argc, char* argv[]) {
   commandLine P(argc,argv," [-s] <inFile>");
   char* iFile = P.getArgument(0);
   bool symmetric = P.getOptionValue("-s");
   bool binary = P.getOptionValue("-b");
+  edgeListFormat edgeList = P.getOptionValue("-e") ? TEXT_EDGE_LIST :
+    P.getOptionValue("-coo") ? BINARY_EDGE_LIST : NO_EDGE_LIST;
+  int cleanup = (P.getOptionValue("-dedup") ? REMOVE_DUPLICATES : 0) |
+    (P.getOptionValue("-noloops") ? REMOVE_SELF_LOOPS : 0) |
+    (P.getOptionValue("-compact") ? COMPACT_IDS : 0);
   long rounds = P.getOptionLongValue("-rounds",3);
+  char* server = P.getOptionValue("-server");
+  char* updates = P.getOptionValue("-updates");
   if(symmetric) {
     graph<symmetricVertex> G =
-      readGraph<symmetricVertex>(iFile,symmetric,binary); //symmetric graph
+      readGraph<symmetricVertex>(iFile,symmetric,binary,edgeList,cleanup); //symmetric graph
+    if(server != NULL) { serveQueries(G,P,server,symmetric); G.del(); return 0; }
+    if(updates != NULL) { runUpdates(G,P,updates); return 0; }
     Compute(G,P);
     for(int r=0;r<rounds;r++) {
       startTime();
@@ -369,7 +582,9 @@ int parallel_main(int argc, char* argv[]) {
     G.del();
   } else {
     graph<asymmetricVertex> G =
-      readGraph<asymmetricVertex>(iFile,symmetric,binary); //asymmetric graph
+      readGraph<asymmetricVertex>(iFile,symmetric,binary,edgeList,cleanup); //asymmetric graph
+    if(server != NULL) { serveQueries(G,P,server,symmetric); G.del(); return 0; }
+    if(updates != NULL) { runUpdates(G,P,updates); return 0; }
     Compute(G,P);
     if(G.transposed) G.transpose();
     for(int r=0;r<rounds;r++) {
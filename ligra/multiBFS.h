@@ -0,0 +1,189 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Bit-parallel multi-source BFS. Runs K = 64*words simultaneous BFS's
+// by keeping a K-bit Visited and NextVisited mask per vertex. A vertex
+// is placed on the next frontier only if some source bit reached it
+// for the first time, so vertices whose masks did not change are
+// skipped in the following round. The bit-vector kernels use AVX2
+// when it is enabled (AVX2=1 in the Makefiles, i.e. -mavx2).
+#ifndef MULTI_BFS_H
+#define MULTI_BFS_H
+#include "ligra.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+//*****BIT-VECTOR KERNELS*****
+
+//returns true if a contains a bit that b does not (i.e. a & ~b != 0)
+inline bool bitsAndNotAny(const ulong* a, const ulong* b, long words) {
+  long i = 0;
+#if defined(__AVX2__)
+  for(;i+4<=words;i+=4) {
+    __m256i va = _mm256_loadu_si256((const __m256i*) (a+i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*) (b+i));
+    //testc returns 1 iff (~vb & va) == 0
+    if(!_mm256_testc_si256(vb,va)) return 1;
+  }
+#endif
+  ulong r = 0;
+  for(;i<words;i++) r |= a[i] & ~b[i];
+  return r != 0;
+}
+
+//c |= a & ~b, word-by-word; only for use when c is not shared
+inline void bitsOrAndNot(ulong* c, const ulong* a, const ulong* b, long words) {
+  long i = 0;
+#if defined(__AVX2__)
+  for(;i+4<=words;i+=4) {
+    __m256i va = _mm256_loadu_si256((const __m256i*) (a+i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*) (b+i));
+    __m256i vc = _mm256_loadu_si256((const __m256i*) (c+i));
+    vc = _mm256_or_si256(vc,_mm256_andnot_si256(vb,va));
+    _mm256_storeu_si256((__m256i*) (c+i),vc);
+  }
+#endif
+  for(;i<words;i++) c[i] |= a[i] & ~b[i];
+}
+
+//atomic version of bitsOrAndNot; words with nothing new are not written
+inline void bitsOrAndNotAtomic(ulong* c, const ulong* a, const ulong* b, long words) {
+  for(long i=0;i<words;i++) {
+    ulong toWrite = a[i] & ~b[i];
+    if(toWrite) writeOr(&c[i],toWrite);
+  }
+}
+
+//number of bits set in a & ~b
+inline long bitsAndNotCount(const ulong* a, const ulong* b, long words) {
+  long r = 0;
+  for(long i=0;i<words;i++) r += __builtin_popcountl(a[i] & ~b[i]);
+  return r;
+}
+
+inline long bitsCount(const ulong* a, long words) {
+  long r = 0;
+  for(long i=0;i<words;i++) r += __builtin_popcountl(a[i]);
+  return r;
+}
+
+//*****MULTI-SOURCE BFS*****
+
+//Update function ORs the bits of s that d has not yet seen into
+//NextVisited[d] and records the round in which d last received a new
+//bit in levels
+template <class ET>
+struct MultiBFS_F {
+  ulong* Visited, *NextVisited;
+  long words;
+  ET* levels;
+  ET round;
+  MultiBFS_F(ulong* _Visited, ulong* _NextVisited, long _words, ET* _levels, ET _round) :
+    Visited(_Visited), NextVisited(_NextVisited), words(_words), levels(_levels), round(_round) {}
+  inline bool update (uintE s, uintE d) {
+    ulong* vs = Visited+s*words, *vd = Visited+d*words;
+    if(!bitsAndNotAny(vs,vd,words)) return 0;
+    bitsOrAndNot(NextVisited+d*words,vs,vd,words);
+    if(levels[d] < round) { levels[d] = round; return 1; }
+    return 0;
+  }
+  inline bool updateAtomic (uintE s, uintE d) {
+    ulong* vs = Visited+s*words, *vd = Visited+d*words;
+    if(!bitsAndNotAny(vs,vd,words)) return 0;
+    bitsOrAndNotAtomic(NextVisited+d*words,vs,vd,words);
+    ET oldLevel = levels[d];
+    if(oldLevel < round) return CAS(&levels[d],oldLevel,round);
+    return 0;
+  }
+  inline bool cond (uintE d) { return cond_true(d); }};
+
+//function passed to vertex map to sync NextVisited and Visited; if
+//distSum is non-NULL, adds (round-1) for each source reaching i for
+//the first time
+struct MultiBFS_Vertex_F {
+  ulong* Visited, *NextVisited;
+  long words, round;
+  long* distSum;
+  MultiBFS_Vertex_F(ulong* _Visited, ulong* _NextVisited, long _words, long _round, long* _distSum) :
+    Visited(_Visited), NextVisited(_NextVisited), words(_words), round(_round), distSum(_distSum) {}
+  inline bool operator() (uintE i) {
+    ulong* v = Visited+i*words, *nv = NextVisited+i*words;
+    if(distSum != NULL) distSum[i] += (round-1)*bitsAndNotCount(nv,v,words);
+    for(long j=0;j<words;j++) v[j] = nv[j];
+    return 1;
+  }
+};
+
+struct multiBFS {
+  long n, words, maxWords;
+  ulong* Visited, *NextVisited;
+  char option; //passed to edgeMap, e.g. EDGE_STREAM
+  //allocates masks for at least k sources (rounded up to a multiple of 64)
+  multiBFS(long _n, long k) : n(_n), option(DENSE) {
+    words = maxWords = max((long)1,(k+63)/64);
+    Visited = newA(ulong,n*words);
+    NextVisited = newA(ulong,n*words);
+    clear();
+  }
+  void del() { free(Visited); free(NextVisited); }
+  long numSources() { return 64*words; }
+  //uses fewer words per vertex for later runs (e.g. small components)
+  void setWords(long w) { words = max((long)1,min(w,maxWords)); }
+  void clear() {
+    parallel_for(long i=0;i<n*words;i++) Visited[i] = NextVisited[i] = 0;
+  }
+  //zero the masks of vertex v only
+  void clear(uintE v) {
+    for(long j=0;j<words;j++) Visited[v*words+j] = NextVisited[v*words+j] = 0;
+  }
+  //make v source number i; safe to call in parallel
+  void addSource(uintE v, long i) {
+    writeOr(&NextVisited[v*words+i/64],(ulong) 1<<(i%64));
+  }
+  bool reached(uintE v, long i) {
+    return (Visited[v*words+i/64] >> (i%64)) & 1;
+  }
+  long numReached(uintE v) { return bitsCount(Visited+v*words,words); }
+
+  //Runs all BFS's starting from Frontier, whose members should have
+  //been given bits with addSource. levels[v] is set to the last round
+  //in which v received a new bit, i.e. the largest distance from any
+  //source to v. Frontier is consumed. Returns the number of rounds.
+  template <class vertex, class ET>
+  long run(graph<vertex>& GA, vertexSubset& Frontier, ET* levels, long* distSum = NULL) {
+    long round = 0;
+    while(!Frontier.isEmpty()){
+      round++;
+      vertexMap(Frontier, MultiBFS_Vertex_F(Visited,NextVisited,words,round,distSum));
+      vertexSubset output = edgeMap(GA, Frontier, MultiBFS_F<ET>(Visited,NextVisited,words,levels,(ET)round),GA.m/20,option);
+      Frontier.del();
+      Frontier = output;
+    }
+    Frontier.del();
+    return round;
+  }
+};
+
+#endif
@@ -0,0 +1,167 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Relaxed priority scheduler for edgeMapScheduled (in ligra.h), after
+// the MultiQueue of Rihani, Sanders and Dementiev: c binary heaps per
+// worker, each with its own lock. A vertex is added to a random heap
+// with the priority P(v) it has at that time (smaller first), and next
+// takes the minimum of the better of two random heaps, so vertices are
+// processed in roughly increasing order of priority without a global
+// queue or rounds. A vertex is added again every time it is activated;
+// an entry whose priority is larger than the current priority of its
+// vertex is stale (the vertex was added again with a smaller one) and
+// is dropped. The counters say how much the relaxation costs: stale
+// entries, and vertices that were processed more than once. Included
+// from ligra.h.
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+#include <sched.h>
+#include "parallel.h"
+#include "utils.h"
+
+struct prioEntry {
+  long key;
+  uintE v;
+};
+
+//binary min-heap of entries, used while its lock is held
+struct lockedHeap {
+  volatile int lock;
+  volatile long top; //key of the minimum, or LONG_MAX if empty
+  prioEntry* A;
+  long size, capacity;
+  long pushes, pops, stale, reprocessed;
+  char pad[64]; //keeps the locks of different heaps on different lines
+
+  void init() {
+    lock = 0; top = LONG_MAX; size = 0; capacity = 16;
+    A = newA(prioEntry,capacity);
+    pushes = pops = stale = reprocessed = 0;
+  }
+  inline bool tryLock() { return lock == 0 && __sync_bool_compare_and_swap(&lock,0,1); }
+  inline void unlock() { __sync_lock_release(&lock); }
+  inline void push(prioEntry e) {
+    if(size == capacity) {
+      prioEntry* B = newA(prioEntry,2*capacity);
+      for(long i=0;i<size;i++) B[i] = A[i];
+      free(A); A = B; capacity *= 2;
+    }
+    long i = size++;
+    while(i > 0 && A[(i-1)/2].key > e.key) { A[i] = A[(i-1)/2]; i = (i-1)/2; }
+    A[i] = e;
+    top = A[0].key;
+  }
+  inline prioEntry pop() {
+    prioEntry r = A[0], e = A[--size];
+    long i = 0;
+    while(2*i+1 < size) {
+      long c = 2*i+1;
+      if(c+1 < size && A[c+1].key < A[c].key) c++;
+      if(A[c].key >= e.key) break;
+      A[i] = A[c]; i = c;
+    }
+    if(size > 0) A[i] = e;
+    top = size > 0 ? A[0].key : LONG_MAX;
+    return r;
+  }
+};
+
+template <class PF>
+struct multiQueue {
+  long numQueues;
+  lockedHeap* Q;
+  PF P;
+  bool* processed;
+  volatile long pending, numAdded;
+  //c heaps per worker; P(v) gives the priority of v
+  multiQueue(long n, PF _P, long c=2) : P(_P), pending(0), numAdded(0) {
+    numQueues = c*getWorkers();
+    if(numQueues < 2) numQueues = 2;
+    Q = newA(lockedHeap,numQueues);
+    for(long i=0;i<numQueues;i++) Q[i].init();
+    processed = newA(bool,n);
+    {parallel_for(long i=0;i<n;i++) processed[i] = 0;}
+  }
+  void del() {
+    for(long i=0;i<numQueues;i++) free(Q[i].A);
+    free(Q); free(processed);
+  }
+
+  //random heap, from a generator kept by each thread
+  inline long randomQueue() {
+    static __thread ulong state = 0;
+    if(state == 0) state = hashInt((ulong) &state) | 1;
+    state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+    return state % numQueues;
+  }
+  inline bool activate(uintE v) {
+    prioEntry e = {P(v), v};
+    __sync_fetch_and_add(&pending,1);
+    __sync_fetch_and_add(&numAdded,1);
+    while(1) {
+      long i = randomQueue();
+      if(Q[i].tryLock()) { Q[i].push(e); Q[i].pushes++; Q[i].unlock(); return 1; }
+    }
+  }
+  inline bool next(uintE& v) {
+    while(pending > 0) {
+      long i = randomQueue(), j = randomQueue();
+      if(Q[j].top < Q[i].top) i = j;
+      if(Q[i].top == LONG_MAX) {
+	//both empty; look for any heap with entries
+	long k = 0;
+	while(k < numQueues && Q[(i+k) % numQueues].top == LONG_MAX) k++;
+	if(k == numQueues) return 0;
+	i = (i+k) % numQueues;
+      }
+      lockedHeap& H = Q[i];
+      if(!H.tryLock()) continue;
+      if(H.size == 0) { H.unlock(); continue; }
+      prioEntry e = H.pop();
+      if(e.key > P(e.v)) { H.stale++; H.unlock(); finish(); continue; }
+      if(processed[e.v] || !CAS(&processed[e.v],(bool)0,(bool)1)) H.reprocessed++;
+      H.pops++;
+      H.unlock();
+      v = e.v;
+      return 1;
+    }
+    return 0;
+  }
+  inline void finish() { __sync_fetch_and_add(&pending,-1); }
+  inline bool done() { return pending == 0; }
+  inline void wait() { sched_yield(); }
+  inline long added() { return numAdded; }
+
+  //entries added, vertices processed, stale entries dropped, and
+  //vertices processed again after their first time
+  void counters(long& pushes, long& pops, long& stale, long& reprocessed) {
+    pushes = pops = stale = reprocessed = 0;
+    for(long i=0;i<numQueues;i++) {
+      pushes += Q[i].pushes; pops += Q[i].pops;
+      stale += Q[i].stale; reprocessed += Q[i].reprocessed;
+    }
+  }
+};
+
+#endif
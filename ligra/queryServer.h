@@ -0,0 +1,321 @@
+// This code is part of the project "Ligra: A Lightweight Graph Processing
+// Framework for Shared Memory", presented at Principles and Practice of
+// Parallel Programming, 2013.
+// Copyright (c) 2013 Julian Shun and Guy Blelloch
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Resident query server used by the driver when "-server <path>" is
+// given. The graph is loaded once and each input line is run as one
+// call to Compute, with the words on the line used as its command
+// line options (e.g. "-r 17"). Queries are read from a Unix domain
+// socket at <path>, or from stdin if <path> is "-", and placed on a
+// bounded queue (-queue, default 64) served by -workers threads
+// (default 1), each of which runs its queries with an equal share of
+// the threads. Each query gets the reply "<id> ok <queue ms> <run ms>
+// <k>", followed by the k lines of its answer, which Compute writes to
+// queryAnswer(), or "<id> error <message>" if its "-r" or "-k" option
+// is not valid for the graph. The line "quit" stops the server.
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+#include <vector>
+#include <deque>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <stdio.h>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "gettime.h"
+#include "utils.h"
+#include "graph.h"
+#include "parseCommandLine.h"
+using namespace std;
+
+template<class vertex>
+void Compute(graph<vertex>&, commandLine);
+
+//Answer of the query run by the calling thread, which the server sends
+//back to the client; NULL when Compute is not run by the server, so
+//apps only write their results when it is set.
+inline ostream*& queryAnswer() {
+  static thread_local ostream* answer = NULL;
+  return answer;
+}
+
+//writes "v A[v]" for the vertices v with A[v] != none to the answer of
+//the current query, if there is one
+template <class T>
+void answerVertexValues(T* A, long n, T none) {
+  ostream* answer = queryAnswer();
+  if(answer == NULL) return;
+  for(long v=0;v<n;v++) if(A[v] != none) *answer << v << " " << A[v] << "\n";
+}
+
+//a client connection; fd is closed once the last query holding it is done
+struct queryConn {
+  int fd;
+  mutex m;
+  queryConn(int _fd) : fd(_fd) {}
+  ~queryConn() { if(fd > STDOUT_FILENO) close(fd); }
+  void reply(const string& s) {
+    lock_guard<mutex> l(m);
+    if(fd == STDOUT_FILENO) { cout << s << flush; return; }
+    send(fd,s.c_str(),s.size(),MSG_NOSIGNAL);
+  }
+};
+
+struct query {
+  long id;
+  vector<string> args;
+  shared_ptr<queryConn> conn;
+  double arrival;
+};
+
+//bounded blocking queue; push blocks when cap queries are pending
+struct queryQueue {
+  deque<query> Q;
+  long cap;
+  bool closed;
+  mutex m;
+  condition_variable notEmpty, notFull;
+  queryQueue(long _cap) : cap(max(_cap,(long)1)), closed(0) {}
+  bool push(const query& q) {
+    unique_lock<mutex> l(m);
+    notFull.wait(l,[&]{ return closed || (long)Q.size() < cap; });
+    if(closed) return 0;
+    Q.push_back(q);
+    notEmpty.notify_one();
+    return 1;
+  }
+  bool pop(query& q) {
+    unique_lock<mutex> l(m);
+    notEmpty.wait(l,[&]{ return closed || !Q.empty(); });
+    if(Q.empty()) return 0;
+    q = Q.front(); Q.pop_front();
+    notFull.notify_one();
+    return 1;
+  }
+  //no more pushes; pop drains what is left
+  void close() {
+    lock_guard<mutex> l(m);
+    closed = 1;
+    notEmpty.notify_all(); notFull.notify_all();
+  }
+};
+
+struct queryServer {
+  queryQueue Q;
+  long nextId;
+  bool stopping;
+  int listenFd;
+  mutex m; //protects nextId, stopping and latencies
+  vector<double> waitTimes, runTimes;
+  timer clock;
+  queryServer(long cap) : Q(cap), nextId(0), stopping(0), listenFd(-1) {}
+
+  void stop() {
+    {lock_guard<mutex> l(m);
+      if(stopping) return;
+      stopping = 1;}
+    Q.close();
+    if(listenFd >= 0) shutdown(listenFd,SHUT_RDWR);
+  }
+
+  //parses one line into a query and enqueues it; false on "quit"
+  bool submit(const string& line, shared_ptr<queryConn> conn) {
+    stringstream ss(line);
+    query q;
+    string w;
+    while(ss >> w) q.args.push_back(w);
+    if(q.args.empty()) return 1;
+    if(q.args[0] == "quit") { stop(); return 0; }
+    {lock_guard<mutex> l(m); q.id = nextId++;}
+    q.conn = conn;
+    q.arrival = clock.getTime();
+    if(!Q.push(q)) { conn->reply("-1 error server stopping\n"); return 0; }
+    return 1;
+  }
+
+  //reads newline-separated queries from fd until EOF or quit
+  void readQueries(shared_ptr<queryConn> conn, int fd) {
+    string buf;
+    char chunk[4096];
+    long r;
+    while((r = read(fd,chunk,sizeof(chunk))) > 0) {
+      buf.append(chunk,r);
+      size_t nl;
+      while((nl = buf.find('\n')) != string::npos) {
+	string line = buf.substr(0,nl);
+	buf.erase(0,nl+1);
+	if(!submit(line,conn)) return;
+      }
+    }
+    if(!buf.empty()) submit(buf,conn);
+  }
+
+  //checks the options of a query that apps use without checking them:
+  //"-r" must be a vertex of a graph with n vertices (or a
+  //comma-separated list of them) and "-k" a non-negative integer.
+  //Returns the error, or an empty string if the query can be run.
+  static string checkQuery(const vector<string>& args, long n) {
+    for(long i=0;i<args.size();i++) {
+      if(args[i] != "-r" && args[i] != "-k") continue;
+      if(i+1 == args.size()) return args[i]+" needs a value";
+      stringstream values(args[i+1]);
+      string v;
+      while(getline(values,v,',')) {
+	char* end;
+	long x = strtol(v.c_str(),&end,10);
+	if(v.empty() || *end != 0) return "bad value "+v+" for "+args[i];
+	if(args[i] == "-r" && (x < 0 || x >= n))
+	  return "vertex "+v+" is not in the graph (n = "+to_string(n)+")";
+	if(args[i] == "-k" && x < 0) return "-k must not be negative";
+      }
+    }
+    return "";
+  }
+
+  template <class vertex>
+  void worker(graph<vertex>& G, char* progName, char* iFile) {
+    query q;
+    while(Q.pop(q)) {
+      string error = checkQuery(q.args,G.n);
+      if(!error.empty()) {
+	q.conn->reply(to_string(q.id)+" error "+error+"\n");
+	continue;
+      }
+      //build an argv of the form <prog> <query options> <file>
+      long argc = q.args.size()+2;
+      char** argv = newA(char*,argc);
+      argv[0] = progName;
+      for(long i=0;i<q.args.size();i++) argv[i+1] = (char*) q.args[i].c_str();
+      argv[argc-1] = iFile;
+      stringstream answer;
+      queryAnswer() = &answer;
+      double start = clock.getTime();
+      Compute(G,commandLine(argc,argv));
+      if(G.transposed) G.transpose();
+      double end = clock.getTime();
+      queryAnswer() = NULL;
+      free(argv);
+      double waitT = 1000*(start-q.arrival), runT = 1000*(end-start);
+      {lock_guard<mutex> l(m);
+	waitTimes.push_back(waitT); runTimes.push_back(runT);}
+      string a = answer.str();
+      if(!a.empty() && a[a.size()-1] != '\n') a += '\n';
+      stringstream ss;
+      ss << q.id << " ok " << waitT << " " << runT << " "
+	 << count(a.begin(),a.end(),'\n') << "\n" << a;
+      q.conn->reply(ss.str());
+    }
+  }
+
+  //p-th quantile of the sorted A[0..k-1], interpolated between the
+  //closest ranks
+  static double quantile(vector<double>& A, long k, double p) {
+    double x = p*(k-1);
+    long i = (long) x;
+    if(i >= k-1) return A[k-1];
+    return A[i]+(x-i)*(A[i+1]-A[i]);
+  }
+
+  void report() {
+    long k = runTimes.size();
+    cout << "queries served = " << k << endl;
+    if(k == 0) return;
+    vector<double> total(k);
+    for(long i=0;i<k;i++) total[i] = waitTimes[i]+runTimes[i];
+    sort(total.begin(),total.end());
+    double sum = 0;
+    for(long i=0;i<k;i++) sum += total[i];
+    cout << "latency (ms): mean = " << sum/k << " p50 = " << quantile(total,k,0.5)
+	 << " p99 = " << quantile(total,k,0.99) << " max = " << total[k-1] << endl;
+  }
+};
+
+//Runs the query server on G until "quit" (or EOF on stdin). Concurrent
+//workers are only used on symmetric graphs, since Compute on an
+//asymmetric graph may transpose it.
+template <class vertex>
+void serveQueries(graph<vertex>& G, commandLine P, char* path, bool symmetric) {
+  long workers = max((long)1,P.getOptionLongValue("-workers",1));
+  if(!symmetric && workers > 1) {
+    cout << "server: asymmetric graph, using 1 worker" << endl;
+    workers = 1;
+  }
+  queryServer S(P.getOptionLongValue("-queue",64));
+  char* iFile = P.getArgument(0);
+  //with OpenMP each worker would otherwise start a team of all the
+  //threads for every parallel loop; Cilk workers are shared by all
+  //threads already
+  long threads = max((long)1,getWorkers()/workers);
+  vector<thread> pool;
+  for(long i=0;i<workers;i++)
+    pool.push_back(thread([&]{
+#ifdef OPENMP
+	  omp_set_num_threads(threads);
+#endif
+	  S.worker(G,P.argv[0],iFile); }));
+
+  if((string) path == "-") {
+    shared_ptr<queryConn> conn(new queryConn(STDOUT_FILENO));
+    S.readQueries(conn,STDIN_FILENO);
+    S.stop();
+  } else {
+    sockaddr_un addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path)) {
+      cout << "server: socket path too long" << endl; abort(); }
+    strcpy(addr.sun_path,path);
+    unlink(path);
+    S.listenFd = socket(AF_UNIX,SOCK_STREAM,0);
+    if(S.listenFd < 0 || bind(S.listenFd,(sockaddr*) &addr,sizeof(addr)) < 0
+       || listen(S.listenFd,16) < 0) {
+      cout << "server: unable to listen on " << path << endl; abort(); }
+    cout << "server: listening on " << path << endl;
+    vector<thread> readers;
+    vector<shared_ptr<queryConn> > conns;
+    while(1) {
+      int fd = accept(S.listenFd,NULL,NULL);
+      if(fd < 0) break;
+      shared_ptr<queryConn> conn(new queryConn(fd));
+      conns.push_back(conn);
+      readers.push_back(thread([&S,conn,fd]{ S.readQueries(conn,fd); }));
+    }
+    //stop() was called; unblock readers still waiting on their clients
+    for(long i=0;i<conns.size();i++) shutdown(conns[i]->fd,SHUT_RD);
+    for(long i=0;i<readers.size();i++) readers[i].join();
+    conns.clear();
+    close(S.listenFd);
+    unlink(path);
+  }
+  for(long i=0;i<workers;i++) pool[i].join();
+  S.report();
+}
+
+#endif